@@ -21,6 +21,8 @@
  ***************************************************************************/
 #include "booleancondition.h"
 
+#include "node/numbernode.h"
+
 Dice::CONDITION_STATE testEqual(bool insideRange, const std::pair<qint64, qint64>& range)
 {
     if(!insideRange)
@@ -150,9 +152,23 @@ void BooleanCondition::setOperator(LogicOperator m)
     m_operator= m;
 }
 
+BooleanCondition::LogicOperator BooleanCondition::getOperator() const
+{
+    return m_operator;
+}
+
 void BooleanCondition::setValueNode(ExecutionNode* v)
 {
     m_value= v;
+    // a number is read once, instead of running its node for each die.
+    auto number= dynamic_cast<NumberNode*>(v);
+    m_constant= nullptr != number && number->getNumber() == static_cast<int>(number->getNumber());
+    m_constantValue= m_constant ? number->getNumber() : 0;
+}
+
+ExecutionNode* BooleanCondition::getValueNode() const
+{
+    return m_value;
 }
 QString BooleanCondition::toString()
 {
@@ -210,9 +226,16 @@ Dice::CONDITION_STATE BooleanCondition::isValidRangeSize(const std::pair<qint64,
     }
     return state;
 }
+bool BooleanCondition::dependsOnRollsOnly() const
+{
+    // any other value node may roll dice for each die.
+    return m_constant;
+}
+
 Validator* BooleanCondition::getCopy() const
 {
     BooleanCondition* val= new BooleanCondition();
+    val->setConditionType(m_conditionType);
     val->setOperator(m_operator);
     val->setValueNode(m_value->getCopy());
     return val;
@@ -221,6 +244,8 @@ qint64 BooleanCondition::valueToScalar() const
 {
     if(m_value == nullptr)
         return 0;
+    if(m_constant)
+        return m_constantValue;
 
     m_value->run(nullptr);
     auto result= m_value->getResult();
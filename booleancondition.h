@@ -48,10 +48,13 @@ public:
     virtual qint64 hasValid(Die* b, bool recursive, bool unhighlight= false) const override;
 
     void setOperator(LogicOperator m);
+    LogicOperator getOperator() const;
     void setValueNode(ExecutionNode*);
+    ExecutionNode* getValueNode() const;
     QString toString() override;
 
     virtual Dice::CONDITION_STATE isValidRangeSize(const std::pair<qint64, qint64>& range) const override;
+    bool dependsOnRollsOnly() const override;
     /**
      * @brief getCopy
      * @return
@@ -64,6 +67,8 @@ private:
 private:
     LogicOperator m_operator;
     ExecutionNode* m_value= nullptr;
+    bool m_constant= false;
+    qint64 m_constantValue= 0;
 };
 
 Q_DECLARE_METATYPE(BooleanCondition::LogicOperator)
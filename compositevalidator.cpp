@@ -21,6 +21,7 @@
  ***************************************************************************/
 #include "compositevalidator.h"
 
+#include <algorithm>
 #include <map>
 
 CompositeValidator::CompositeValidator() {}
@@ -187,10 +188,21 @@ void CompositeValidator::setValidatorList(const QList<Validator*>& valids)
     qDeleteAll(m_validatorList);
     m_validatorList= valids;
 }
+bool CompositeValidator::dependsOnRollsOnly() const
+{
+    return std::all_of(m_validatorList.begin(), m_validatorList.end(),
+                       [](Validator* validator) { return validator->dependsOnRollsOnly(); });
+}
+
 Validator* CompositeValidator::getCopy() const
 {
     CompositeValidator* val= new CompositeValidator();
+    val->setConditionType(m_conditionType);
     val->setOperationList(m_operators);
-    val->setValidatorList(m_validatorList);
+    // validators are deleted with their composite: the copy owns its own ones.
+    QList<Validator*> validators;
+    for(auto validator : m_validatorList)
+        validators.append(validator->getCopy());
+    val->setValidatorList(validators);
     return val;
 }
@@ -53,6 +53,7 @@ public:
     QString toString() override;
 
     virtual Dice::CONDITION_STATE isValidRangeSize(const std::pair<qint64, qint64>& range) const override;
+    bool dependsOnRollsOnly() const override;
 
     virtual Validator* getCopy() const override;
 
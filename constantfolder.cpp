@@ -0,0 +1,154 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "constantfolder.h"
+
+#include <cmath>
+#include <limits>
+
+#include "node/ifnode.h"
+#include "node/numbernode.h"
+#include "node/parenthesesnode.h"
+#include "node/repeaternode.h"
+#include "node/rerolldicenode.h"
+#include "node/scalaroperatornode.h"
+#include "node/valueslistnode.h"
+
+ConstantFolder::ConstantFolder() {}
+
+int ConstantFolder::fold(std::vector<ExecutionNode*>& instructions)
+{
+    ConstantFolder folder;
+    for(auto& instruction : instructions)
+        instruction= folder.chain(instruction);
+    return folder.m_folded;
+}
+
+ExecutionNode* ConstantFolder::chain(ExecutionNode* head)
+{
+    // arithmetic reads the result of the node before it: only the beginning of a chain can be dice-free.
+    ExecutionNode* last= nullptr;
+    int count= 0;
+    for(auto node= head; nullptr != node && isConstant(node, node == head); node= node->getNextNode())
+    {
+        last= node;
+        ++count;
+    }
+
+    qint64 value= 0;
+    if(nullptr != last && (count > 1 || nullptr == dynamic_cast<NumberNode*>(head)))
+    {
+        auto rest= last->getNextNode();
+        last->setNextNode(nullptr);
+        if(evaluate(head, last, value))
+        {
+            auto number= new NumberNode();
+            number->setNumber(value);
+            number->setNextNode(rest);
+            delete head;
+            head= number;
+            ++m_folded;
+        }
+        else
+        {
+            head->reset();
+            last->setNextNode(rest);
+        }
+    }
+
+    for(auto node= head; nullptr != node; node= node->getNextNode())
+        internals(node);
+    return head;
+}
+
+void ConstantFolder::internals(ExecutionNode* node)
+{
+    if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+    {
+        operation->setInternalNode(chain(operation->getInternalNode()));
+    }
+    else if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+    {
+        parentheses->setInternelNode(chain(parentheses->getInternalNode()));
+    }
+    else if(auto reroll= dynamic_cast<RerollDiceNode*>(node))
+    {
+        reroll->setInstruction(chain(reroll->getInstruction()));
+    }
+    else if(auto repeater= dynamic_cast<RepeaterNode*>(node))
+    {
+        auto command= repeater->getCommand();
+        for(auto& instruction : command)
+            instruction= chain(instruction);
+        repeater->setCommand(command);
+    }
+    else if(auto condition= dynamic_cast<IfNode*>(node))
+    {
+        condition->setInstructionTrue(chain(condition->getInstructionTrue()));
+        condition->setInstructionFalse(chain(condition->getInstructionFalse()));
+    }
+    else if(auto list= dynamic_cast<ValuesListNode*>(node))
+    {
+        auto values= list->getValues();
+        for(auto& value : values)
+            value= chain(value);
+        list->setValues(values);
+    }
+}
+
+bool ConstantFolder::isConstant(ExecutionNode* node, bool first)
+{
+    if(first && nullptr != dynamic_cast<NumberNode*>(node))
+        return true;
+    if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+        return first && isConstantChain(parentheses->getInternalNode());
+    if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+        return !first && isConstantChain(operation->getInternalNode());
+    return false;
+}
+
+bool ConstantFolder::isConstantChain(ExecutionNode* head)
+{
+    if(nullptr == head)
+        return false;
+    for(auto node= head; nullptr != node; node= node->getNextNode())
+    {
+        if(!isConstant(node, node == head))
+            return false;
+    }
+    return true;
+}
+
+bool ConstantFolder::evaluate(ExecutionNode* head, ExecutionNode* last, qint64& value)
+{
+    head->run(nullptr);
+    auto result= last->getResult();
+    if(nullptr == result || !head->getExecutionErrorMap().isEmpty())
+        return false;
+
+    // a NumberNode holds an integer: divisions giving a fraction stay computed at run time.
+    auto real= result->getResult(Dice::RESULT_TYPE::SCALAR).toReal();
+    constexpr qreal limit= static_cast<qreal>(std::numeric_limits<qint32>::max());
+    if(!std::isfinite(real) || std::trunc(real) != real || std::abs(real) > limit)
+        return false;
+    value= static_cast<qint64>(real);
+    return true;
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef CONSTANTFOLDER_H
+#define CONSTANTFOLDER_H
+
+#include <QtGlobal>
+#include <vector>
+
+class ExecutionNode;
+
+/**
+ * @brief The ConstantFolder class replaces the dice-free parts of parsed instructions (numbers, parentheses and
+ * arithmetic on them) by a single NumberNode, computed once at parse time instead of at each run. A part is only
+ * folded when it gives an integer without error, so results stay the ones of the original tree. Chains inside
+ * operators, parentheses, rerolls, repeat(), the branches of if and the values of [] lists are folded too.
+ */
+class ConstantFolder
+{
+public:
+    /**
+     * @brief fold rewrites the given instructions in place.
+     * @return number of parts replaced by a constant.
+     */
+    static int fold(std::vector<ExecutionNode*>& instructions);
+
+private:
+    ConstantFolder();
+    ExecutionNode* chain(ExecutionNode* head);
+    void internals(ExecutionNode* node);
+    static bool isConstant(ExecutionNode* node, bool first);
+    static bool isConstantChain(ExecutionNode* head);
+    static bool evaluate(ExecutionNode* head, ExecutionNode* last, qint64& value);
+
+private:
+    int m_folded= 0;
+};
+
+#endif // CONSTANTFOLDER_H
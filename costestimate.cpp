@@ -0,0 +1,438 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "costestimate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "executionbudget.h"
+#include "node/allsamenode.h"
+#include "node/countexecutenode.h"
+#include "node/dicerollernode.h"
+#include "node/explodedicenode.h"
+#include "node/groupnode.h"
+#include "node/ifnode.h"
+#include "node/keepdiceexecnode.h"
+#include "node/listsetrollnode.h"
+#include "node/numbernode.h"
+#include "node/parenthesesnode.h"
+#include "node/repeaternode.h"
+#include "node/rerolldicenode.h"
+#include "node/scalaroperatornode.h"
+#include "node/valueslistnode.h"
+#include "node/variablenode.h"
+#include "validatorlist.h"
+
+namespace
+{
+constexpr qreal infinite= std::numeric_limits<qreal>::infinity();
+// probability left to a random loop beyond its worst case, for each die.
+constexpr qreal tailProbability= 1e-6;
+// beyond this number of dice, the group search is already too long to be counted.
+constexpr int maxGroupDice= 1000;
+
+/**
+ * @brief The Flow struct is what is known of the result a node gives to the next one.
+ */
+struct Flow
+{
+    bool pool= false;
+    CostEstimate::Measure size;      /// dice in the pool
+    CostEstimate::Measure value;     /// scalar value, or sum of the pool
+    std::pair<qint64, qint64> range; /// faces of the dice in the pool
+};
+
+qreal times(qreal count, qreal cost)
+{
+    // a loop which is never entered costs nothing, even if it would never end.
+    return (0.0 == count || 0.0 == cost) ? 0.0 : count * cost;
+}
+
+void accumulate(CostEstimate::Measure& measure, qreal expected, qreal worst)
+{
+    measure.expected+= expected;
+    measure.worst+= worst;
+}
+
+qreal mean(const std::pair<qint64, qint64>& range)
+{
+    return (static_cast<qreal>(range.first) + static_cast<qreal>(range.second)) / 2.0;
+}
+
+qreal highest(const std::pair<qint64, qint64>& range)
+{
+    return std::max(std::abs(static_cast<qreal>(range.first)), std::abs(static_cast<qreal>(range.second)));
+}
+
+Flow scalar(qreal expected, qreal worst)
+{
+    Flow flow;
+    flow.value.expected= expected;
+    flow.value.worst= worst;
+    return flow;
+}
+
+qreal probability(ValidatorList* list, const Flow& flow)
+{
+    if(nullptr == list || !flow.pool)
+        return 0.0;
+    return list->validProbability(flow.range);
+}
+
+/**
+ * @brief geometric
+ * @return extra turns of a loop which goes on with probability p.
+ */
+CostEstimate::Measure geometric(qreal p)
+{
+    CostEstimate::Measure turns;
+    if(p <= 0.0)
+        return turns;
+    if(p >= 1.0)
+    {
+        turns.expected= infinite;
+        turns.worst= infinite;
+        return turns;
+    }
+    turns.expected= p / (1.0 - p);
+    turns.worst= std::ceil(std::log(tailProbability) / std::log(p));
+    return turns;
+}
+
+Flow combine(const Flow& left, const Flow& right, Die::ArithmeticOperator op)
+{
+    switch(op)
+    {
+    case Die::PLUS:
+        return scalar(left.value.expected + right.value.expected, left.value.worst + right.value.worst);
+    case Die::MINUS:
+        return scalar(left.value.expected - right.value.expected, left.value.worst + right.value.worst);
+    case Die::MULTIPLICATION:
+        return scalar(left.value.expected * right.value.expected, left.value.worst * right.value.worst);
+    case Die::DIVIDE:
+    case Die::INTEGER_DIVIDE:
+        return scalar(left.value.expected / std::max(1.0, right.value.expected), left.value.worst);
+    case Die::POW:
+        return scalar(std::pow(left.value.expected, right.value.expected),
+                      std::pow(left.value.worst, right.value.worst));
+    }
+    return left;
+}
+} // namespace
+
+/**
+ * @brief The CostEstimate::Walker class follows the nodes of instructions, in the order they run, and adds the cost of
+ * each one to an estimate.
+ */
+class CostEstimate::Walker
+{
+public:
+    explicit Walker(CostEstimate& cost) : m_cost(cost) {}
+
+    void instructions(const std::vector<ExecutionNode*>& list)
+    {
+        for(auto start : list)
+        {
+            auto flow= chain(start, Flow());
+            if(flow.pool)
+                accumulate(m_cost.m_output, flow.size.expected, flow.size.worst);
+            else
+                accumulate(m_cost.m_output, 1.0, 1.0);
+            m_finals.push_back(flow);
+        }
+    }
+
+    Flow chain(ExecutionNode* node, Flow flow)
+    {
+        for(; nullptr != node; node= node->getNextNode())
+            step(node, flow);
+        return flow;
+    }
+
+    const std::vector<Flow>& finals() const { return m_finals; }
+
+private:
+    void step(ExecutionNode* node, Flow& flow)
+    {
+        if(auto number= dynamic_cast<NumberNode*>(node))
+        {
+            flow= scalar(number->getNumber(), std::abs(static_cast<qreal>(number->getNumber())));
+        }
+        else if(auto roller= dynamic_cast<DiceRollerNode*>(node))
+        {
+            roll(flow, roller->getRange());
+        }
+        else if(auto list= dynamic_cast<ListSetRollNode*>(node))
+        {
+            roll(flow, std::pair<qint64, qint64>(1, std::max<qint64>(1, list->getList().size())));
+        }
+        else if(auto values= dynamic_cast<ValuesListNode*>(node))
+        {
+            valueList(values, flow);
+        }
+        else if(auto explode= dynamic_cast<ExplodeDiceNode*>(node))
+        {
+            loop(flow, geometric(probability(explode->getValidatorList(), flow)), true);
+        }
+        else if(auto reroll= dynamic_cast<RerollDiceNode*>(node))
+        {
+            rerollLoop(reroll, flow);
+        }
+        else if(dynamic_cast<AllSameNode*>(node))
+        {
+            // dice are all rolled again while they all show the same face.
+            auto faces= static_cast<qreal>(flow.range.second - flow.range.first) + 1.0;
+            auto dice= std::round(flow.size.expected);
+            loop(flow, geometric(faces <= 1.0 || dice <= 1.0 ? 1.0 : std::pow(faces, 1.0 - dice)), true);
+        }
+        else if(dynamic_cast<GroupNode*>(node))
+        {
+            // groups are searched among the subsets of the dice.
+            auto dice= static_cast<int>(std::min<qreal>(flow.size.worst, maxGroupDice));
+            accumulate(m_cost.m_iterations, flow.size.expected * flow.size.expected, std::ldexp(flow.size.worst, dice));
+            flow= scalar(flow.size.expected, flow.size.worst);
+        }
+        else if(auto keep= dynamic_cast<KeepDiceExecNode*>(node))
+        {
+            keepDice(keep->getDiceKeepNumber(), flow);
+        }
+        else if(auto count= dynamic_cast<CountExecuteNode*>(node))
+        {
+            auto p= probability(count->getValidatorList(), flow);
+            flow= scalar(flow.size.expected * p, flow.size.worst);
+        }
+        else if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+        {
+            flow= combine(flow, chain(operation->getInternalNode(), Flow()), operation->getArithmeticOperator());
+        }
+        else if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+        {
+            flow= chain(parentheses->getInternalNode(), Flow());
+        }
+        else if(auto repeater= dynamic_cast<RepeaterNode*>(node))
+        {
+            repeat(repeater, flow);
+        }
+        else if(auto condition= dynamic_cast<IfNode*>(node))
+        {
+            branch(condition, flow);
+        }
+        else if(auto variable= dynamic_cast<VariableNode*>(node))
+        {
+            if(variable->getIndex() < m_finals.size())
+                flow= m_finals[variable->getIndex()];
+        }
+    }
+
+    void roll(Flow& flow, const std::pair<qint64, qint64>& range)
+    {
+        auto expected= std::max(0.0, flow.value.expected);
+        auto worst= std::max(0.0, flow.value.worst);
+        accumulate(m_cost.m_dice, expected, worst);
+        accumulate(m_cost.m_rolls, expected, worst);
+        flow.pool= true;
+        flow.range= range;
+        flow.size.expected= expected;
+        flow.size.worst= worst;
+        flow.value.expected= expected * mean(range);
+        flow.value.worst= worst * highest(range);
+    }
+
+    void valueList(ValuesListNode* values, Flow& flow)
+    {
+        Flow list;
+        list.pool= true;
+        auto low= infinite;
+        auto high= -infinite;
+        for(auto value : values->getValues())
+        {
+            auto item= chain(value, Flow());
+            accumulate(list.size, 1.0, 1.0);
+            accumulate(list.value, item.value.expected, item.value.worst);
+            low= std::min(low, std::floor(item.value.expected));
+            high= std::max(high, std::ceil(item.value.worst));
+        }
+        if(low <= high)
+            list.range= std::make_pair(static_cast<qint64>(low), static_cast<qint64>(high));
+        accumulate(m_cost.m_dice, list.size.expected, list.size.worst);
+        flow= list;
+    }
+
+    /**
+     * @brief loop adds the rolls made by a loop running turns times on each die of the pool.
+     */
+    CostEstimate::Measure loop(Flow& flow, const CostEstimate::Measure& turns, bool adding)
+    {
+        CostEstimate::Measure extra;
+        extra.expected= times(flow.size.expected, turns.expected);
+        extra.worst= times(flow.size.worst, turns.worst);
+        accumulate(m_cost.m_rolls, extra.expected, extra.worst);
+        accumulate(m_cost.m_iterations, extra.expected, extra.worst);
+        if(std::isinf(extra.worst))
+            m_cost.m_endless= true;
+        if(adding)
+            accumulate(flow.value, times(extra.expected, mean(flow.range)), times(extra.worst, highest(flow.range)));
+        return extra;
+    }
+
+    void rerollLoop(RerollDiceNode* reroll, Flow& flow)
+    {
+        auto p= probability(reroll->getValidatorList(), flow);
+        CostEstimate::Measure turns;
+        if(!reroll->isRerollOnce())
+            turns= geometric(p);
+        else if(p > 0.0)
+        {
+            turns.expected= p;
+            turns.worst= 1.0;
+        }
+        auto extra= loop(flow, turns, reroll->isAdding());
+        if(nullptr == reroll->getInstruction())
+            return;
+        // each reroll runs the instruction in place of the die.
+        CostEstimate instruction;
+        Walker(instruction).chain(reroll->getInstruction(), Flow());
+        m_cost.add(instruction, extra.expected, extra.worst);
+    }
+
+    void keepDice(qint64 number, Flow& flow)
+    {
+        auto keep= [number](qreal size) {
+            return std::max(0.0, number < 0 ? size + static_cast<qreal>(number) :
+                                              std::min(size, static_cast<qreal>(number)));
+        };
+        auto expected= keep(flow.size.expected);
+        auto worst= keep(flow.size.worst);
+        flow.value.expected= flow.size.expected > 0.0 ? flow.value.expected * expected / flow.size.expected : 0.0;
+        flow.value.worst= flow.size.worst > 0.0 ? flow.value.worst * worst / flow.size.worst : 0.0;
+        flow.size.expected= expected;
+        flow.size.worst= worst;
+    }
+
+    void repeat(RepeaterNode* repeater, Flow& flow)
+    {
+        auto count= chain(repeater->getTimeNode(), Flow()).value;
+        count.expected= std::max(0.0, count.expected);
+        count.worst= std::max(0.0, count.worst);
+
+        CostEstimate command;
+        Walker walker(command);
+        walker.instructions(repeater->getCommand());
+        m_cost.add(command, count.expected, count.worst);
+        accumulate(m_cost.m_iterations, count.expected, count.worst);
+
+        if(repeater->isSumAll())
+        {
+            CostEstimate::Measure sum;
+            for(auto const& result : walker.finals())
+                accumulate(sum, result.value.expected, result.value.worst);
+            flow= scalar(times(count.expected, sum.expected), times(count.worst, sum.worst));
+        }
+        else
+        {
+            // every run is written down.
+            flow= Flow();
+            flow.pool= true;
+            flow.size.expected= times(count.expected, command.m_output.expected);
+            flow.size.worst= times(count.worst, command.m_output.worst);
+        }
+    }
+
+    void branch(IfNode* condition, Flow& flow)
+    {
+        auto p= flow.pool ? probability(condition->getValidatorList(), flow) : 0.5;
+        CostEstimate yes;
+        CostEstimate no;
+        auto yesFlow= Walker(yes).chain(condition->getInstructionTrue(), flow);
+        auto noFlow= Walker(no).chain(condition->getInstructionFalse(), flow);
+
+        // only one branch runs: its expected cost is weighted by its probability, the worst is the costliest one.
+        auto merge= [p](CostEstimate::Measure& total, const CostEstimate::Measure& a, const CostEstimate::Measure& b) {
+            total.expected+= p * a.expected + (1.0 - p) * b.expected;
+            total.worst+= std::max(a.worst, b.worst);
+        };
+        merge(m_cost.m_dice, yes.m_dice, no.m_dice);
+        merge(m_cost.m_rolls, yes.m_rolls, no.m_rolls);
+        merge(m_cost.m_iterations, yes.m_iterations, no.m_iterations);
+        m_cost.m_endless= m_cost.m_endless || yes.m_endless || no.m_endless;
+
+        flow= p >= 0.5 ? yesFlow : noFlow;
+        flow.size.worst= std::max(yesFlow.size.worst, noFlow.size.worst);
+        flow.value.worst= std::max(yesFlow.value.worst, noFlow.value.worst);
+    }
+
+private:
+    CostEstimate& m_cost;
+    std::vector<Flow> m_finals;
+};
+
+CostEstimate::CostEstimate() {}
+
+CostEstimate CostEstimate::estimate(const std::vector<ExecutionNode*>& instructions)
+{
+    CostEstimate cost;
+    Walker(cost).instructions(instructions);
+    return cost;
+}
+
+const CostEstimate::Measure& CostEstimate::dice() const
+{
+    return m_dice;
+}
+
+const CostEstimate::Measure& CostEstimate::rolls() const
+{
+    return m_rolls;
+}
+
+const CostEstimate::Measure& CostEstimate::iterations() const
+{
+    return m_iterations;
+}
+
+const CostEstimate::Measure& CostEstimate::output() const
+{
+    return m_output;
+}
+
+bool CostEstimate::isEndless() const
+{
+    return m_endless;
+}
+
+bool CostEstimate::fits(const ExecutionBudget& budget) const
+{
+    if(m_endless)
+        return false;
+    if(budget.maxDice() > 0 && m_dice.worst > static_cast<qreal>(budget.maxDice()))
+        return false;
+    return budget.maxRolls() == 0 || m_rolls.worst <= static_cast<qreal>(budget.maxRolls());
+}
+
+void CostEstimate::add(const CostEstimate& other, qreal expected, qreal worst)
+{
+    accumulate(m_dice, times(expected, other.m_dice.expected), times(worst, other.m_dice.worst));
+    accumulate(m_rolls, times(expected, other.m_rolls.expected), times(worst, other.m_rolls.worst));
+    accumulate(m_iterations, times(expected, other.m_iterations.expected), times(worst, other.m_iterations.worst));
+    m_endless= m_endless || (other.m_endless && worst > 0.0);
+}
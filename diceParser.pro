@@ -38,10 +38,21 @@ DEFINES+= HAVE_GUI
 
 SOURCES += diceparser.cpp \
     result/diceresult.cpp \
+    result/compactdicelist.cpp \
+    result/dicehistogram.cpp \
     range.cpp \
     booleancondition.cpp \
     validator.cpp \
     die.cpp \
+    randomengine.cpp \
+    dicearena.cpp \
+    diceprogram.cpp \
+    executionbudget.cpp \
+    costestimate.cpp \
+    instructionschedule.cpp \
+    constantfolder.cpp \
+    outputcache.cpp \
+    preparedcommand.cpp \
     result/result.cpp \
     result/scalarresult.cpp \
     parsingtoolbox.cpp \
@@ -52,11 +63,22 @@ SOURCES += diceparser.cpp \
 
 HEADERS += \
     diceparser.h \
+    preparedcommand.h \
+    executionbudget.h \
+    costestimate.h \
+    outputcache.h \
     result/diceresult.h \
+    result/compactdicelist.h \
+    result/dicehistogram.h \
     range.h \
     booleancondition.h \
     validator.h \
     die.h \
+    randomengine.h \
+    dicearena.h \
+    diceprogram.h \
+    instructionschedule.h \
+    constantfolder.h \
     result/result.h \
     result/scalarresult.h \
     result/parsingtoolbox.h \
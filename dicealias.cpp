@@ -67,11 +67,12 @@ QString makeReplament(const QString& pattern, const QString& replacement, QStrin
             std::vector<int> patternPosList;
             std::vector<std::pair<int, int>> variablePos;
 
+            static const QRegularExpression variableExp("\\${\\N+}");
             int pos= 0;
             QRegularExpressionMatch match;
             while(pos != -1)
             {
-                auto start= cmd.indexOf(QRegularExpression("\\${\\N+}"), pos, &match);
+                auto start= cmd.indexOf(variableExp, pos, &match);
                 if(start >= 0)
                 {
                     auto end= start + match.captured().length();
@@ -138,6 +139,7 @@ DiceAlias::DiceAlias(QString cmd, QString key, bool isReplace, bool isEnable)
     {
         m_type= REGEXP;
     }
+    compileExpression();
 }
 
 DiceAlias::~DiceAlias() {}
@@ -149,6 +151,20 @@ DiceAlias::DiceAlias(const DiceAlias& alias)
     m_value= alias.getValue();
     m_isEnable= alias.isEnable();
     m_type= alias.isReplace() ? REPLACE : REGEXP;
+    m_expression= alias.m_expression;
+}
+
+void DiceAlias::compileExpression()
+{
+    if(m_type == REGEXP)
+    {
+        m_expression.setPattern(m_command);
+        m_expression.optimize();
+    }
+    else
+    {
+        m_expression= QRegularExpression();
+    }
 }
 
 bool DiceAlias::resolved(QString& str)
@@ -164,8 +180,7 @@ bool DiceAlias::resolved(QString& str)
     }
     else if(m_type == REGEXP)
     {
-        QRegularExpression exp(m_command);
-        str.replace(exp, m_value);
+        str.replace(m_expression, m_value);
         return true;
     }
     return false;
@@ -174,6 +189,7 @@ bool DiceAlias::resolved(QString& str)
 void DiceAlias::setCommand(QString key)
 {
     m_command= key;
+    compileExpression();
 }
 
 void DiceAlias::setValue(QString value)
@@ -184,6 +200,7 @@ void DiceAlias::setValue(QString value)
 void DiceAlias::setType(RESOLUTION_TYPE type)
 {
     m_type= type;
+    compileExpression();
 }
 QString DiceAlias::getCommand() const
 {
@@ -210,6 +227,7 @@ void DiceAlias::setReplace(bool b)
     {
         m_type= REGEXP;
     }
+    compileExpression();
 }
 
 bool DiceAlias::isEnable() const
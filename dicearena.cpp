@@ -0,0 +1,125 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "dicearena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace
+{
+// each object is preceded by the arena it comes from, nullptr for the heap.
+constexpr std::size_t headerSize= alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t) : sizeof(void*);
+
+std::size_t alignedSize(std::size_t size)
+{
+    return (size + headerSize - 1) / headerSize * headerSize;
+}
+
+thread_local DiceArena* currentArena= nullptr;
+std::atomic<quint64> heapAllocations(0);
+} // namespace
+
+DiceArena::DiceArena(std::size_t chunkSize) : m_chunkSize(chunkSize) {}
+
+DiceArena::~DiceArena()
+{
+    for(auto& chunk : m_chunks)
+        ::operator delete(chunk.data);
+}
+
+void* DiceArena::allocate(std::size_t size)
+{
+    size= alignedSize(size);
+    while(m_index < m_chunks.size() && m_offset + size > m_chunks[m_index].size)
+    {
+        ++m_index;
+        m_offset= 0;
+    }
+    if(m_index == m_chunks.size())
+    {
+        auto chunkSize= std::max(m_chunkSize, size);
+        m_chunks.push_back({static_cast<char*>(::operator new(chunkSize)), chunkSize});
+        m_offset= 0;
+    }
+
+    auto pointer= m_chunks[m_index].data + m_offset;
+    m_offset+= size;
+    ++m_allocationCount;
+    return pointer;
+}
+
+void DiceArena::reset()
+{
+    m_index= 0;
+    m_offset= 0;
+    m_allocationCount= 0;
+}
+
+std::size_t DiceArena::allocationCount() const
+{
+    return m_allocationCount;
+}
+
+DiceArena* DiceArena::setCurrent(DiceArena* arena)
+{
+    auto previous= currentArena;
+    currentArena= arena;
+    return previous;
+}
+
+DiceArena* DiceArena::current()
+{
+    return currentArena;
+}
+
+quint64 DiceArena::heapAllocationCount()
+{
+    return heapAllocations;
+}
+
+void* ArenaObject::operator new(std::size_t size)
+{
+    auto arena= currentArena;
+    void* block= nullptr;
+    if(nullptr != arena)
+    {
+        block= arena->allocate(headerSize + size);
+    }
+    else
+    {
+        block= ::operator new(headerSize + size);
+        ++heapAllocations;
+    }
+    *static_cast<DiceArena**>(block)= arena;
+    return static_cast<char*>(block) + headerSize;
+}
+
+void ArenaObject::operator delete(void* pointer)
+{
+    if(nullptr == pointer)
+        return;
+
+    auto block= static_cast<char*>(pointer) - headerSize;
+    if(nullptr == *reinterpret_cast<DiceArena**>(block))
+        ::operator delete(block);
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef DICEARENA_H
+#define DICEARENA_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief The DiceArena class is a monotonic buffer owned by a DiceParser. Nodes, results and dice created while the
+ * parser is parsing or running are carved out of it, and all of them are given back at once by reset(). Its chunks are
+ * kept, so a parser running the same kind of command again does not call the system allocator.
+ */
+class DiceArena
+{
+public:
+    explicit DiceArena(std::size_t chunkSize= 16 * 1024);
+    ~DiceArena();
+    DiceArena(const DiceArena&)= delete;
+    DiceArena& operator=(const DiceArena&)= delete;
+
+    void* allocate(std::size_t size);
+    /**
+     * @brief reset makes all the memory of the arena available again. Objects allocated from it must not be used
+     * anymore.
+     */
+    void reset();
+    /**
+     * @brief allocationCount
+     * @return number of objects allocated since the last reset.
+     */
+    std::size_t allocationCount() const;
+
+    /**
+     * @brief setCurrent makes the ArenaObject created afterwards by the calling thread come from the given arena,
+     * nullptr sends them back to the heap.
+     * @return arena given by the previous call.
+     */
+    static DiceArena* setCurrent(DiceArena* arena);
+    static DiceArena* current();
+    /**
+     * @brief heapAllocationCount
+     * @return number of ArenaObject allocated on the heap since the start of the process, in all threads.
+     */
+    static quint64 heapAllocationCount();
+
+private:
+    struct Chunk
+    {
+        char* data;
+        std::size_t size;
+    };
+    std::vector<Chunk> m_chunks;
+    std::size_t m_chunkSize;
+    std::size_t m_index= 0;
+    std::size_t m_offset= 0;
+    std::size_t m_allocationCount= 0;
+};
+
+/**
+ * @brief The ArenaObject class gives its subclasses an operator new using the current arena of the thread, if any.
+ * delete stays valid for both kinds of objects: it runs the destructor, and only heap memory is freed.
+ */
+class ArenaObject
+{
+public:
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer);
+};
+
+#endif // DICEARENA_H
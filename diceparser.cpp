@@ -27,20 +27,33 @@
 #include <QJsonObject>
 #include <QObject>
 #include <QStringList>
+#include <algorithm>
 #include <functional>
 #include <numeric>
+#include <unordered_set>
 
 #include "booleancondition.h"
+#include "constantfolder.h"
 #include "dicealias.h"
+#include "dicearena.h"
+#include "diceprogram.h"
+#include "instructionschedule.h"
 #include "parsingtoolbox.h"
+#include "randomengine.h"
 #include "range.h"
 #include "result/stringresult.h"
 #include "validator.h"
 
 #define DEFAULT_FACES_NUMBER 10
 
-DiceParser::DiceParser() : m_parsingToolbox(new ParsingToolBox()) {}
-DiceParser::~DiceParser() {}
+DiceParser::DiceParser() : m_parsingToolbox(new ParsingToolBox()), m_arena(new DiceArena())
+{
+    setRandomEngine(Dice::RANDOM_ENGINE::MT19937);
+}
+DiceParser::~DiceParser()
+{
+    releasePreparedNodes();
+}
 
 const QList<DiceAlias*>& DiceParser::constAliases() const
 {
@@ -49,27 +62,65 @@ const QList<DiceAlias*>& DiceParser::constAliases() const
 
 QList<DiceAlias*>* DiceParser::aliases() const
 {
+    // the list may be edited through the pointer: la (list aliases) plans can not be trusted anymore.
+    m_planCache.clear();
+    m_outputCache.clear();
     return m_parsingToolbox->aliases();
 }
 
 void DiceParser::cleanAliases()
 {
+    m_planCache.clear();
+    m_outputCache.clear();
     m_parsingToolbox->cleanUpAliases();
 }
 void DiceParser::insertAlias(DiceAlias* dice, int i)
 {
+    m_planCache.clear();
+    m_outputCache.clear();
     m_parsingToolbox->insertAlias(dice, i);
 }
 
 bool DiceParser::parseLine(QString str, bool allowAlias)
 {
+    resetArena();
     if(allowAlias)
     {
         str= m_parsingToolbox->convertAlias(str);
     }
+    m_outputKey= str;
+    if(m_planCache.capacity() <= 0)
+        return parseCommand(str);
+
+    checkPlanCache();
+    auto key= PreparedCommandCache::normalize(str);
+    auto cached= m_planCache.find(key);
+    if(cached.isValid())
+    {
+        loadPrepared(cached);
+        // the plan may come from another spelling of the command: the output shows the one given now.
+        m_command= str;
+        m_command.remove(cached.comment());
+        return true;
+    }
+
+    bool parsed= false;
+    auto plan= parsePlan(str, &parsed);
+    // a command whose nodes could not all be copied runs from its parsed tree, without a plan.
+    if(plan.isValid())
+        m_planCache.insert(key, plan);
+    return parsed;
+}
+
+bool DiceParser::parseCommand(QString str)
+{
     m_parsingToolbox->clearUp();
     m_command= str;
+    auto previousArena= DiceArena::setCurrent(m_arena.get());
     auto instructions= m_parsingToolbox->readInstructionList(str, true);
+    m_foldedConstantCount= m_constantFoldingEnabled ? ConstantFolder::fold(*m_parsingToolbox->getStartNodeList()) : 0;
+    m_pure= ParsingToolBox::isPure(m_parsingToolbox->getStartNodes());
+    DiceArena::setCurrent(previousArena);
     m_command.remove(m_parsingToolbox->getComment());
     bool value= !instructions.empty();
     if(!value)
@@ -102,10 +153,282 @@ QString DiceParser::convertAlias(const QString& cmd) const
 
 void DiceParser::start()
 {
+    if(m_tapeRecorder)
+        m_tapeRecorder->clearTape();
+    if(m_tapePlayer)
+        m_tapePlayer->rewind();
+    // nodes without an engine of their own (prepared commands) draw from the engine of this parser.
+    auto previous= RandomEngine::setThreadEngine(m_parsingToolbox->getRandomEngine().get());
+    auto previousArena= DiceArena::setCurrent(m_arena.get());
+    m_budget.start();
+    auto previousBudget= ExecutionBudget::setCurrent(&m_budget);
+    if(m_bytecodeEnabled && m_programs.empty())
+        compilePrograms();
+    auto const& startNodes= m_parsingToolbox->getStartNodes();
+    auto schedule= InstructionSchedule::analyse(startNodes);
+    auto workers= schedule.workerCount();
+    // an arena is not shared between threads: each helper thread gets its own.
+    while(m_arena && m_workerArenas.size() + 1 < static_cast<std::size_t>(workers))
+        m_workerArenas.emplace_back(new DiceArena());
+    auto engine= m_parsingToolbox->getRandomEngine().get();
+    schedule.run(
+        [this, &startNodes, engine](std::size_t i, int worker) {
+            auto arena= (0 == worker || !m_arena) ? m_arena.get() : m_workerArenas[worker - 1].get();
+            auto previousWorkerArena= DiceArena::setCurrent(arena);
+            auto previousWorkerEngine= RandomEngine::setThreadEngine(engine);
+            if(i < m_programs.size() && m_programs[i]->isValid())
+                m_programs[i]->run();
+            else
+                startNodes[i]->run();
+            RandomEngine::setThreadEngine(previousWorkerEngine);
+            DiceArena::setCurrent(previousWorkerArena);
+        },
+        workers);
+    ExecutionBudget::setCurrent(previousBudget);
+    DiceArena::setCurrent(previousArena);
+    RandomEngine::setThreadEngine(previous);
+}
+
+void DiceParser::compilePrograms()
+{
+    m_programs.clear();
     for(auto start : m_parsingToolbox->getStartNodes())
+        m_programs.emplace_back(new DiceProgram(DiceProgram::compile(start)));
+}
+
+void DiceParser::setConstantFoldingEnabled(bool enabled)
+{
+    // plans of the cache were parsed with the previous setting.
+    if(enabled != m_constantFoldingEnabled)
+        m_planCache.clear();
+    m_constantFoldingEnabled= enabled;
+}
+
+bool DiceParser::isConstantFoldingEnabled() const
+{
+    return m_constantFoldingEnabled;
+}
+
+int DiceParser::foldedConstantCount() const
+{
+    return m_foldedConstantCount;
+}
+
+void DiceParser::setBytecodeEnabled(bool enabled)
+{
+    m_bytecodeEnabled= enabled;
+    m_programs.clear();
+}
+
+bool DiceParser::isBytecodeEnabled() const
+{
+    return m_bytecodeEnabled;
+}
+
+ExecutionBudget& DiceParser::executionBudget()
+{
+    return m_budget;
+}
+
+const ExecutionBudget& DiceParser::executionBudget() const
+{
+    return m_budget;
+}
+
+CostEstimate DiceParser::estimateCost() const
+{
+    return CostEstimate::estimate(m_parsingToolbox->getStartNodes());
+}
+
+int DiceParser::compiledInstructionCount() const
+{
+    return static_cast<int>(std::count_if(m_programs.begin(), m_programs.end(),
+                                          [](const std::unique_ptr<DiceProgram>& program) {
+                                              return program->isValid();
+                                          }));
+}
+
+PreparedCommand DiceParser::prepare(QString str, bool allowAlias)
+{
+    resetArena();
+    m_outputKey= QString();
+    if(allowAlias)
+        str= m_parsingToolbox->convertAlias(str);
+
+    if(m_planCache.capacity() <= 0)
+        return parsePlan(str);
+
+    checkPlanCache();
+    auto key= PreparedCommandCache::normalize(str);
+    auto plan= m_planCache.find(key);
+    if(!plan.isValid())
+    {
+        plan= parsePlan(str);
+        if(plan.isValid())
+            m_planCache.insert(key, plan);
+    }
+    return plan;
+}
+
+PreparedCommand DiceParser::parsePlan(const QString& str, bool* parsed)
+{
+    // a plan is shared between runs and threads, so its nodes must not hold the engine of this parser.
+    m_parsingToolbox->setRandomEngine(nullptr);
+    auto value= parseCommand(str);
+    if(nullptr != parsed)
+        *parsed= value;
+    updateRandomEngine();
+    return PreparedCommand::build(m_command, m_parsingToolbox->getComment(), m_parsingToolbox->getErrorList(),
+                                  m_parsingToolbox->getWarningList(), m_parsingToolbox->getStartNodes());
+}
+
+bool DiceParser::start(const PreparedCommand& command)
+{
+    if(!command.isValid())
+        return false;
+
+    resetArena();
+    loadPrepared(command);
+    // the plan may not come from a command given to parseLine: its output is not cached.
+    m_outputKey= QString();
+    start();
+    return true;
+}
+
+void DiceParser::loadPrepared(const PreparedCommand& command)
+{
+    m_command= command.command();
+    m_parsingToolbox->clearUp();
+    m_foldedConstantCount= 0;
+    m_parsingToolbox->setComment(command.comment());
+    auto const& warnings= command.warningMap();
+    for(auto it= warnings.begin(); it != warnings.end(); ++it)
+        m_parsingToolbox->addWarning(it.key(), it.value());
+
+    auto startNodes= m_parsingToolbox->getStartNodeList();
+    auto previousArena= DiceArena::setCurrent(m_arena.get());
+    command.instantiate(*startNodes);
+    DiceArena::setCurrent(previousArena);
+    m_preparedNodes= *startNodes;
+    m_pure= ParsingToolBox::isPure(*startNodes);
+}
+
+void DiceParser::setPlanCacheSize(int size)
+{
+    m_planCache.setCapacity(size);
+}
+
+int DiceParser::planCacheSize() const
+{
+    return m_planCache.capacity();
+}
+
+int DiceParser::cachedPlanCount() const
+{
+    return m_planCache.size();
+}
+
+void DiceParser::clearPlanCache()
+{
+    m_planCache.clear();
+}
+
+void DiceParser::checkPlanCache()
+{
+    auto generation= ParsingToolBox::variableHashGeneration();
+    if(generation == m_planVariableGeneration)
+        return;
+    m_planCache.clear();
+    m_outputCache.clear();
+    m_planVariableGeneration= generation;
+}
+
+bool DiceParser::isPure() const
+{
+    return m_pure;
+}
+
+void DiceParser::setOutputCacheSize(int size)
+{
+    m_outputCache.setCapacity(size);
+}
+
+int DiceParser::outputCacheSize() const
+{
+    return m_outputCache.capacity();
+}
+
+int DiceParser::cachedOutputCount() const
+{
+    return m_outputCache.size();
+}
+
+void DiceParser::clearOutputCache()
+{
+    m_outputCache.clear();
+}
+
+QString DiceParser::cachedOutput(QString command, const QString& format, bool allowAlias)
+{
+    if(m_outputCache.capacity() <= 0)
+        return QString();
+    if(allowAlias)
+        command= m_parsingToolbox->convertAlias(command);
+    checkPlanCache();
+    return m_outputCache.find(command, format);
+}
+
+void DiceParser::storeOutput(const QString& format, const QString& output)
+{
+    if(m_pure && !m_outputKey.isNull())
+        m_outputCache.insert(m_outputKey, format, output);
+}
+
+void DiceParser::resetArena()
+{
+    // programs point to the nodes of the previous command.
+    m_programs.clear();
+    releasePreparedNodes();
+    if(!m_arena)
+        return;
+    // the nodes of the previous command live in the arena.
+    m_parsingToolbox->setStartNodes(std::vector<ExecutionNode*>());
+    m_arena->reset();
+    for(auto& arena : m_workerArenas)
+        arena->reset();
+}
+
+void DiceParser::setArenaEnabled(bool enabled)
+{
+    resetArena();
+    m_arena.reset(enabled ? new DiceArena() : nullptr);
+    m_workerArenas.clear();
+}
+
+bool DiceParser::isArenaEnabled() const
+{
+    return nullptr != m_arena;
+}
+
+void DiceParser::releasePreparedNodes()
+{
+    if(m_preparedNodes.empty())
+        return;
+
+    // merge (m) links instructions to each other while running: only the heads of the chains are deleted.
+    std::unordered_set<ExecutionNode*> chained;
+    for(auto node : m_preparedNodes)
+    {
+        for(auto next= node->getNextNode(); nullptr != next; next= next->getNextNode())
+            chained.insert(next);
+    }
+    for(auto node : m_preparedNodes)
     {
-        start->run();
+        if(chained.find(node) == chained.end())
+            delete node;
     }
+    m_preparedNodes.clear();
+    m_parsingToolbox->setStartNodes(std::vector<ExecutionNode*>());
 }
 
 QString DiceParser::diceCommand() const
@@ -170,6 +493,14 @@ QMap<Dice::ERROR_CODE, QString> DiceParser::errorMap() const
             map.insert(key, mapTmp[key]);
         }
     }
+    for(auto const& program : m_programs)
+    {
+        auto const& errors= program->errors();
+        for(auto it= errors.begin(); it != errors.end(); ++it)
+            map.insert(it.key(), it.value());
+    }
+    if(m_budget.isExhausted())
+        map.insert(m_budget.errorCode(), m_budget.errorMessage());
     return map;
 }
 QString DiceParser::humanReadableError() const
@@ -258,9 +589,65 @@ void DiceParser::writeDownDotTree(QString filepath)
 }
 void DiceParser::setPathToHelp(QString l)
 {
+    m_planCache.clear();
+    m_outputCache.clear();
     m_parsingToolbox->setHelpPath(l);
 }
 void DiceParser::setVariableDictionary(const QHash<QString, QString>& variables)
 {
     ParsingToolBox::setVariableHash(variables);
 }
+void DiceParser::setRandomEngine(Dice::RANDOM_ENGINE type)
+{
+    m_randomEngine.reset(RandomEngine::create(type));
+    if(m_tapeRecorder)
+        m_tapeRecorder.reset(new TapeRecorderEngine(m_randomEngine));
+    updateRandomEngine();
+}
+void DiceParser::setSeed(quint64 seed)
+{
+    m_randomEngine->seed(seed);
+}
+void DiceParser::startRecording()
+{
+    m_tapePlayer.reset();
+    m_tapeRecorder.reset(new TapeRecorderEngine(m_randomEngine));
+    updateRandomEngine();
+}
+void DiceParser::startReplay(const RollTape& tape)
+{
+    m_tapeRecorder.reset();
+    m_tapePlayer.reset(new TapePlayerEngine(tape));
+    updateRandomEngine();
+}
+void DiceParser::stopRollTape()
+{
+    m_tapeRecorder.reset();
+    m_tapePlayer.reset();
+    updateRandomEngine();
+}
+RollTape DiceParser::rollTape() const
+{
+    if(m_tapeRecorder)
+        return m_tapeRecorder->tape();
+    if(m_tapePlayer)
+        return m_tapePlayer->tape();
+    return RollTape();
+}
+bool DiceParser::isReplayExhausted() const
+{
+    return m_tapePlayer && m_tapePlayer->exhausted();
+}
+void DiceParser::updateRandomEngine()
+{
+    if(m_tapePlayer)
+        m_parsingToolbox->setRandomEngine(m_tapePlayer);
+    else if(m_tapeRecorder)
+        m_parsingToolbox->setRandomEngine(m_tapeRecorder);
+    else
+        m_parsingToolbox->setRandomEngine(m_randomEngine);
+}
+RandomEngine* DiceParser::randomEngine() const
+{
+    return m_parsingToolbox->getRandomEngine().get();
+}
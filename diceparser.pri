@@ -6,11 +6,22 @@ INCLUDEPATH += $$PWD
 
 SOURCES += $$PWD/diceparser.cpp \
     $$PWD/result/diceresult.cpp \
+    $$PWD/result/compactdicelist.cpp \
+    $$PWD/result/dicehistogram.cpp \
     $$PWD/range.cpp \
     $$PWD/highlightdice.cpp \
     $$PWD/booleancondition.cpp \
     $$PWD/validator.cpp \
     $$PWD/die.cpp \
+    $$PWD/randomengine.cpp \
+    $$PWD/dicearena.cpp \
+    $$PWD/diceprogram.cpp \
+    $$PWD/executionbudget.cpp \
+    $$PWD/costestimate.cpp \
+    $$PWD/instructionschedule.cpp \
+    $$PWD/constantfolder.cpp \
+    $$PWD/outputcache.cpp \
+    $$PWD/preparedcommand.cpp \
     $$PWD/result/result.cpp \
     $$PWD/result/scalarresult.cpp \
     $$PWD/parsingtoolbox.cpp \
@@ -54,12 +65,23 @@ SOURCES += $$PWD/diceparser.cpp \
 
 HEADERS += \
     $$PWD/include/diceparser.h \
+    $$PWD/include/preparedcommand.h \
+    $$PWD/include/executionbudget.h \
+    $$PWD/include/costestimate.h \
+    $$PWD/include/outputcache.h \
     $$PWD/result/diceresult.h \
+    $$PWD/result/compactdicelist.h \
+    $$PWD/result/dicehistogram.h \
     $$PWD/range.h \
     $$PWD/booleancondition.h \
     $$PWD/include/highlightdice.h \
     $$PWD/validator.h \
     $$PWD/die.h \
+    $$PWD/randomengine.h \
+    $$PWD/dicearena.h \
+    $$PWD/diceprogram.h \
+    $$PWD/instructionschedule.h \
+    $$PWD/constantfolder.h \
     $$PWD/result/result.h \
     $$PWD/result/scalarresult.h \
     $$PWD/include/parsingtoolbox.h \
@@ -0,0 +1,618 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "diceprogram.h"
+
+#include <QObject>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "booleancondition.h"
+#include "executionbudget.h"
+#include "node/countexecutenode.h"
+#include "node/dicerollernode.h"
+#include "node/explodedicenode.h"
+#include "node/keepdiceexecnode.h"
+#include "node/numbernode.h"
+#include "node/scalaroperatornode.h"
+#include "node/sortresult.h"
+#include "node/startingnode.h"
+#include "randomengine.h"
+#include "result/diceresult.h"
+#include "result/scalarresult.h"
+#include "validatorlist.h"
+
+namespace
+{
+qint64 lastRoll(const std::vector<qint64>& values, const std::vector<std::vector<qint64>>& history, std::size_t i)
+{
+    if(history.empty() || history[i].empty())
+        return values[i];
+    return history[i].back();
+}
+} // namespace
+
+DiceProgram::DiceProgram() {}
+
+DiceProgram DiceProgram::compile(ExecutionNode* start)
+{
+    DiceProgram program;
+    program.m_root= start;
+    Operand current;
+    current.node= start;
+    if(nullptr != dynamic_cast<StartingNode*>(start) && program.compileChain(start->getNextNode(), current))
+        program.m_valid= (Kind::None != current.kind);
+
+    if(!program.m_valid)
+        program.m_instructions.clear();
+    return program;
+}
+
+bool DiceProgram::isValid() const
+{
+    return m_valid;
+}
+
+ExecutionNode* DiceProgram::root() const
+{
+    return m_root;
+}
+
+int DiceProgram::operationCount() const
+{
+    return static_cast<int>(m_instructions.size());
+}
+
+const QMap<Dice::ERROR_CODE, QString>& DiceProgram::errors() const
+{
+    return m_errors;
+}
+
+void DiceProgram::run()
+{
+    if(!m_valid)
+        return;
+    execute();
+    publish();
+}
+
+bool DiceProgram::compileChain(ExecutionNode* node, Operand& current)
+{
+    for(; nullptr != node; node= node->getNextNode())
+    {
+        if(!compileNode(node, current))
+            return false;
+    }
+    return true;
+}
+
+bool DiceProgram::compileNode(ExecutionNode* node, Operand& current)
+{
+    Instruction op;
+    op.node= node;
+    op.previous= current.node;
+    Operand next;
+    next.node= node;
+
+    if(auto number= dynamic_cast<NumberNode*>(node))
+    {
+        op.code= OpCode::Constant;
+        op.value= number->getNumber();
+        next.kind= Kind::Scalar;
+        next.index= op.target= addScalar();
+    }
+    else if(auto roller= dynamic_cast<DiceRollerNode*>(node))
+    {
+        auto range= roller->getRange();
+        // unique values and dice without faces keep their own algorithm.
+        if(roller->getUnique() || 0 == range.second || !toScalar(current, op.source))
+            return false;
+        // a large pool of known size is rolled by the node itself, as a histogram.
+        auto const& size= m_instructions.back();
+        if(OpCode::Constant == size.code && size.target == op.source && size.value > 0
+           && roller->usesHistogram(static_cast<quint64>(size.value)))
+            return false;
+        op.code= OpCode::Roll;
+        op.mode= static_cast<quint8>(roller->getOperator());
+        op.min= range.first;
+        op.max= range.second;
+        op.engine= roller->getRandomEngine().get();
+        next.kind= Kind::Pool;
+        next.range= range;
+        next.index= op.target= addPool();
+    }
+    else if(auto sort= dynamic_cast<SortResultNode*>(node))
+    {
+        if(Kind::Pool != current.kind)
+            return false;
+        op.code= OpCode::Sort;
+        op.mode= sort->isAscending() ? 1 : 0;
+        op.source= current.index;
+        next.kind= Kind::Pool;
+        next.range= current.range;
+        next.index= op.target= addPool();
+    }
+    else if(auto keep= dynamic_cast<KeepDiceExecNode*>(node))
+    {
+        // a negative number is resolved against the size of the pool by the node itself.
+        if(Kind::Pool != current.kind || keep->getDiceKeepNumber() < 0)
+            return false;
+        op.code= OpCode::Keep;
+        op.value= keep->getDiceKeepNumber();
+        op.source= current.index;
+        next.kind= Kind::Pool;
+        next.range= current.range;
+        next.index= op.target= addPool();
+    }
+    else if(auto count= dynamic_cast<CountExecuteNode*>(node))
+    {
+        if(Kind::Pool != current.kind || !readCondition(count->getValidatorList(), op))
+            return false;
+        op.code= OpCode::Count;
+        op.source= current.index;
+        next.kind= Kind::Scalar;
+        next.index= op.target= addScalar();
+    }
+    else if(auto explode= dynamic_cast<ExplodeDiceNode*>(node))
+    {
+        auto validators= explode->getValidatorList();
+        if(Kind::Pool != current.kind || !readCondition(validators, op)
+           || Dice::CONDITION_STATE::ALWAYSTRUE == validators->isValidRangeSize(current.range))
+            return false;
+        op.code= OpCode::Explode;
+        op.min= current.range.first;
+        op.max= current.range.second;
+        op.engine= explode->getRandomEngine().get();
+        op.source= current.index;
+        next.kind= Kind::Pool;
+        next.range= current.range;
+        next.index= op.target= addPool();
+    }
+    else if(auto scalar= dynamic_cast<ScalarOperatorNode*>(node))
+    {
+        // the right operand runs first, with the operator node as previous node.
+        auto internal= scalar->getInternalNode();
+        Operand right;
+        right.node= node;
+        if(nullptr == internal || !compileChain(internal, right) || !toScalar(right, op.operand)
+           || !toScalar(current, op.source))
+            return false;
+        op.code= OpCode::Arithmetic;
+        op.mode= static_cast<quint8>(scalar->getArithmeticOperator());
+        op.internal= internal;
+        next.kind= Kind::Scalar;
+        next.index= op.target= addScalar();
+    }
+    else
+    {
+        return false;
+    }
+
+    m_instructions.push_back(op);
+    current= next;
+    return true;
+}
+
+bool DiceProgram::toScalar(const Operand& operand, quint32& index)
+{
+    switch(operand.kind)
+    {
+    case Kind::Scalar:
+        index= operand.index;
+        return true;
+    case Kind::Pool:
+    {
+        Instruction op;
+        op.code= OpCode::Sum;
+        op.source= operand.index;
+        op.target= addScalar();
+        m_instructions.push_back(op);
+        index= op.target;
+        return true;
+    }
+    case Kind::None:
+        break;
+    }
+    return false;
+}
+
+quint32 DiceProgram::addScalar()
+{
+    m_scalars.push_back(0);
+    return static_cast<quint32>(m_scalars.size() - 1);
+}
+
+quint32 DiceProgram::addPool()
+{
+    m_pools.push_back(Pool());
+    return static_cast<quint32>(m_pools.size() - 1);
+}
+
+bool DiceProgram::readCondition(ValidatorList* list, Instruction& op)
+{
+    if(nullptr == list || list->getValidators().size() != 1)
+        return false;
+
+    auto condition= dynamic_cast<BooleanCondition*>(list->getValidators().first());
+    if(nullptr == condition || condition->getConditionType() != Dice::OnEach)
+        return false;
+
+    auto number= dynamic_cast<NumberNode*>(condition->getValueNode());
+    if(nullptr == number || nullptr != number->getNextNode())
+        return false;
+
+    op.mode= static_cast<quint8>(condition->getOperator());
+    op.value= number->getNumber();
+    return true;
+}
+
+bool DiceProgram::matches(quint8 mode, qint64 value, qint64 reference)
+{
+    switch(static_cast<BooleanCondition::LogicOperator>(mode))
+    {
+    case BooleanCondition::Equal:
+        return value == reference;
+    case BooleanCondition::GreaterThan:
+        return value > reference;
+    case BooleanCondition::LesserThan:
+        return value < reference;
+    case BooleanCondition::GreaterOrEqual:
+        return value >= reference;
+    case BooleanCondition::LesserOrEqual:
+        return value <= reference;
+    case BooleanCondition::Different:
+        return value != reference;
+    }
+    return false;
+}
+
+qint64 DiceProgram::score(const Instruction& op, const Pool& pool, std::size_t i) const
+{
+    if(pool.history.empty() || pool.history[i].empty())
+        return matches(op.mode, pool.values[i], op.value) ? 1 : 0;
+
+    return std::count_if(pool.history[i].begin(), pool.history[i].end(),
+                         [&op](qint64 roll) { return matches(op.mode, roll, op.value); });
+}
+
+qreal DiceProgram::poolScalar(const Pool& pool) const
+{
+    // same reduction as DiceResult::getScalarResult.
+    if(pool.values.size() == 1)
+        return pool.values.front();
+
+    qint64 scalar= 0;
+    for(std::size_t i= 0; i < pool.values.size(); ++i)
+    {
+        auto value= pool.values[i];
+        if(0 == i)
+        {
+            scalar= value;
+            continue;
+        }
+        switch(pool.sumOperator)
+        {
+        case Die::PLUS:
+            scalar+= value;
+            break;
+        case Die::MULTIPLICATION:
+            scalar*= value;
+            break;
+        case Die::MINUS:
+            scalar-= value;
+            break;
+        case Die::POW:
+            scalar= static_cast<int>(std::pow(static_cast<double>(scalar), static_cast<double>(value)));
+            break;
+        case Die::DIVIDE:
+        case Die::INTEGER_DIVIDE:
+            if(value != 0)
+                scalar/= value;
+            break;
+        }
+    }
+    return scalar;
+}
+
+void DiceProgram::execute()
+{
+    m_errors.clear();
+    for(auto const& op : m_instructions)
+    {
+        switch(op.code)
+        {
+        case OpCode::Constant:
+            m_scalars[op.target]= op.value;
+            break;
+        case OpCode::Sum:
+            m_scalars[op.target]= poolScalar(m_pools[op.source]);
+            break;
+        case OpCode::Roll:
+        {
+            auto number= m_scalars[op.source];
+            if(number <= 0)
+                m_errors.insert(Dice::ERROR_CODE::NO_DICE_TO_ROLL, QObject::tr("No dice to roll"));
+            auto& pool= m_pools[op.target];
+            auto count= number > 0 ? static_cast<quint64>(std::min<qreal>(number, DiceRollerNode::maxPoolSize + 1)) : 0;
+            if(count > DiceRollerNode::maxPoolSize)
+            {
+                m_errors.insert(Dice::ERROR_CODE::TOO_MANY_DICE,
+                                QObject::tr("Too many dice: a roll can not have more than %1 dice")
+                                    .arg(DiceRollerNode::maxPoolSize));
+                count= 0;
+            }
+            if(!ExecutionBudget::allowDice(count) || !ExecutionBudget::allowRolls(count))
+                count= 0;
+            pool.values.resize(static_cast<std::size_t>(count));
+            pool.history.clear();
+            pool.dieOperator= static_cast<Die::ArithmeticOperator>(op.mode);
+            pool.sumOperator= pool.dieOperator;
+            auto engine= RandomEngine::select(op.engine);
+            engine->fillBounded(op.min, op.max, pool.values.data(), pool.values.size());
+        }
+        break;
+        case OpCode::Sort:
+        {
+            auto const& source= m_pools[op.source];
+            auto& pool= m_pools[op.target];
+            auto size= source.values.size();
+            // stable ascending order, reversed when descending: the order of the binary insertion of the node.
+            pool.order.resize(size);
+            std::iota(pool.order.begin(), pool.order.end(), 0);
+            std::stable_sort(pool.order.begin(), pool.order.end(),
+                             [&source](quint32 a, quint32 b) { return source.values[a] < source.values[b]; });
+            if(0 == op.mode)
+                std::reverse(pool.order.begin(), pool.order.end());
+
+            pool.values.resize(size);
+            pool.history.clear();
+            if(!source.history.empty())
+                pool.history.resize(size);
+            for(std::size_t i= 0; i < size; ++i)
+            {
+                pool.values[i]= source.values[pool.order[i]];
+                if(!source.history.empty())
+                    pool.history[i]= source.history[pool.order[i]];
+            }
+            pool.dieOperator= source.dieOperator;
+            pool.sumOperator= Die::PLUS;
+        }
+        break;
+        case OpCode::Keep:
+        {
+            auto const& source= m_pools[op.source];
+            auto& pool= m_pools[op.target];
+            auto size= static_cast<qint64>(source.values.size());
+            if(op.value > size)
+            {
+                m_errors.insert(Dice::ERROR_CODE::TOO_MANY_DICE,
+                                QObject::tr(" You ask to keep %1 dice but the result only has %2")
+                                    .arg(op.value)
+                                    .arg(size));
+            }
+            auto kept= static_cast<std::size_t>(std::min(op.value, size));
+            pool.values.assign(source.values.begin(), source.values.begin() + kept);
+            pool.history.clear();
+            if(!source.history.empty())
+                pool.history.assign(source.history.begin(), source.history.begin() + kept);
+            pool.dieOperator= source.dieOperator;
+            pool.sumOperator= Die::PLUS;
+        }
+        break;
+        case OpCode::Count:
+        {
+            auto const& source= m_pools[op.source];
+            qint64 sum= 0;
+            for(std::size_t i= 0; i < source.values.size(); ++i)
+                sum+= score(op, source, i);
+            m_scalars[op.target]= sum;
+        }
+        break;
+        case OpCode::Explode:
+        {
+            auto const& source= m_pools[op.source];
+            auto& pool= m_pools[op.target];
+            pool.values= source.values;
+            pool.history= source.history;
+            pool.dieOperator= source.dieOperator;
+            pool.sumOperator= Die::PLUS;
+
+            m_active.clear();
+            for(std::size_t i= 0; i < pool.values.size(); ++i)
+            {
+                if(matches(op.mode, lastRoll(pool.values, pool.history, i), op.value))
+                    m_active.push_back(static_cast<quint32>(i));
+            }
+            if(!m_active.empty() && pool.history.empty())
+                pool.history.resize(pool.values.size());
+
+            // each pass rolls once every die whose last roll matched, in order, as the node does.
+            auto engine= RandomEngine::select(op.engine);
+            while(!m_active.empty() && ExecutionBudget::allowRolls(m_active.size()))
+            {
+                m_nextActive.clear();
+                for(auto i : m_active)
+                {
+                    auto roll= engine->bounded(op.min, op.max);
+                    auto& rolls= pool.history[i];
+                    if(rolls.empty())
+                        rolls.push_back(pool.values[i]);
+                    rolls.push_back(roll);
+                    pool.values[i]= Die::combine(pool.dieOperator, pool.values[i], roll);
+                    if(matches(op.mode, roll, op.value))
+                        m_nextActive.push_back(i);
+                }
+                std::swap(m_active, m_nextActive);
+            }
+        }
+        break;
+        case OpCode::Arithmetic:
+        {
+            auto a= m_scalars[op.source];
+            auto b= m_scalars[op.operand];
+            auto divide= [this, a, b]() -> qreal {
+                if(qFuzzyCompare(b, 0))
+                {
+                    m_errors.insert(Dice::ERROR_CODE::DIVIDE_BY_ZERO, QObject::tr("Division by zero"));
+                    return 0;
+                }
+                return a / b;
+            };
+            qreal value= 0;
+            switch(static_cast<Die::ArithmeticOperator>(op.mode))
+            {
+            case Die::PLUS:
+                value= static_cast<qint64>(a + b);
+                break;
+            case Die::MINUS:
+                value= static_cast<qint64>(a - b);
+                break;
+            case Die::MULTIPLICATION:
+                value= static_cast<qint64>(a * b);
+                break;
+            case Die::DIVIDE:
+                value= divide();
+                break;
+            case Die::INTEGER_DIVIDE:
+                value= static_cast<int>(divide());
+                break;
+            case Die::POW:
+                value= static_cast<qint64>(std::pow(a, b));
+                break;
+            }
+            m_scalars[op.target]= value;
+        }
+        break;
+        }
+    }
+}
+
+void DiceProgram::publish()
+{
+    for(auto const& op : m_instructions)
+    {
+        // sums are implicit in the tree: nodes read the scalar value of the previous result.
+        if(nullptr == op.node)
+            continue;
+
+        op.node->setPreviousNode(op.previous);
+        Result* previousResult= op.previous->getResult();
+        Result* result= op.node->getResult();
+        switch(op.code)
+        {
+        case OpCode::Constant:
+            result->setPrevious(previousResult);
+            break;
+        case OpCode::Roll:
+        {
+            auto const& pool= m_pools[op.target];
+            result->setPrevious(previousResult);
+            static_cast<DiceResult*>(result)->setCompactResult(op.min, op.max, pool.dieOperator, pool.values.data(),
+                                                               pool.values.size());
+        }
+        break;
+        case OpCode::Sort:
+        {
+            auto const& dice= static_cast<DiceResult*>(previousResult)->getResultList();
+            QList<Die*> sorted;
+            for(auto i : m_pools[op.target].order)
+                sorted.append(new Die(*dice[static_cast<int>(i)]));
+            for(auto die : dice)
+                die->displayed();
+            result->setPrevious(previousResult);
+            static_cast<DiceResult*>(result)->setResultList(sorted);
+        }
+        break;
+        case OpCode::Keep:
+        {
+            auto const& dice= static_cast<DiceResult*>(previousResult)->getResultList();
+            auto kept= static_cast<int>(m_pools[op.target].values.size());
+            QList<Die*> list;
+            for(int i= 0; i < dice.size(); ++i)
+            {
+                if(i < kept)
+                {
+                    list.append(new Die(*dice[i]));
+                    dice[i]->displayed();
+                }
+                else
+                {
+                    dice[i]->setHighlighted(false);
+                }
+            }
+            result->setPrevious(previousResult);
+            static_cast<DiceResult*>(result)->setResultList(list);
+        }
+        break;
+        case OpCode::Count:
+        {
+            auto const& source= m_pools[op.source];
+            auto const& dice= static_cast<DiceResult*>(previousResult)->getResultList();
+            for(int i= 0; i < dice.size(); ++i)
+                dice[i]->setHighlighted(0 != score(op, source, static_cast<std::size_t>(i)));
+            result->setPrevious(previousResult);
+            static_cast<ScalarResult*>(result)->setValue(m_scalars[op.target]);
+        }
+        break;
+        case OpCode::Explode:
+        {
+            auto const& source= m_pools[op.source];
+            auto const& pool= m_pools[op.target];
+            auto const& dice= static_cast<DiceResult*>(previousResult)->getResultList();
+            QList<Die*> list;
+            for(int i= 0; i < dice.size(); ++i)
+            {
+                auto index= static_cast<std::size_t>(i);
+                Die* die= new Die(*dice[i]);
+                if(!pool.history.empty())
+                {
+                    // the copy already holds the rolls of the source die.
+                    auto const& rolls= pool.history[index];
+                    std::size_t known= (source.history.empty() || source.history[index].empty()) ?
+                                           1 :
+                                           source.history[index].size();
+                    for(auto r= known; r < rolls.size(); ++r)
+                        die->insertRollValue(rolls[r]);
+                }
+                die->setHighlighted(true);
+                list.append(die);
+                dice[i]->displayed();
+            }
+            result->setPrevious(previousResult);
+            static_cast<DiceResult*>(result)->setResultList(list);
+        }
+        break;
+        case OpCode::Arithmetic:
+        {
+            ExecutionNode* leaf= op.internal;
+            while(nullptr != leaf->getNextNode())
+                leaf= leaf->getNextNode();
+            result->setPrevious(leaf->getResult());
+            op.internal->getResult()->setPrevious(previousResult);
+            static_cast<ScalarResult*>(result)->setValue(m_scalars[op.target]);
+        }
+        break;
+        case OpCode::Sum:
+            break;
+        }
+    }
+}
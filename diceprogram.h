@@ -0,0 +1,137 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef DICEPROGRAM_H
+#define DICEPROGRAM_H
+
+#include <QMap>
+#include <QString>
+#include <utility>
+#include <vector>
+
+#include "diceparserhelper.h"
+#include "die.h"
+
+class ExecutionNode;
+class RandomEngine;
+class ValidatorList;
+
+/**
+ * @brief The DiceProgram class is one instruction compiled from its execution tree into a flat list of operations on
+ * typed registers: scalars and pools of dice. The interpreter runs them in a single loop, then gives each node of the
+ * tree the result it would have computed, so results are read as usual. An instruction holding a node the compiler
+ * does not know gives an invalid program and keeps running on its tree, which stays the reference implementation.
+ */
+class DiceProgram
+{
+public:
+    enum class OpCode : quint8
+    {
+        Constant,
+        Sum,
+        Roll,
+        Sort,
+        Keep,
+        Count,
+        Explode,
+        Arithmetic
+    };
+
+    DiceProgram();
+    /**
+     * @brief compile
+     * @return program of the instruction beginning at start, invalid if one of its nodes can not be compiled.
+     */
+    static DiceProgram compile(ExecutionNode* start);
+
+    bool isValid() const;
+    ExecutionNode* root() const;
+    int operationCount() const;
+    /**
+     * @brief run executes the operations, then stores their results into the nodes of the tree.
+     */
+    void run();
+    const QMap<Dice::ERROR_CODE, QString>& errors() const;
+
+private:
+    enum class Kind : quint8
+    {
+        None,
+        Scalar,
+        Pool
+    };
+    struct Operand
+    {
+        Kind kind= Kind::None;
+        quint32 index= 0;
+        ExecutionNode* node= nullptr;
+        std::pair<qint64, qint64> range;
+    };
+    struct Instruction
+    {
+        OpCode code= OpCode::Constant;
+        quint8 mode= 0; /// sort order, comparison or arithmetic operator
+        quint32 target= 0;
+        quint32 source= 0;
+        quint32 operand= 0;
+        qint64 value= 0; /// constant, number of kept dice or compared value
+        qint64 min= 0;
+        qint64 max= 0;
+        RandomEngine* engine= nullptr;
+        ExecutionNode* node= nullptr;
+        ExecutionNode* previous= nullptr;
+        ExecutionNode* internal= nullptr;
+    };
+    struct Pool
+    {
+        std::vector<qint64> values;
+        std::vector<std::vector<qint64>> history; /// every roll of a die, empty while it has been rolled once
+        std::vector<quint32> order;               /// index in the source pool of each die, once sorted
+        Die::ArithmeticOperator dieOperator= Die::PLUS;
+        Die::ArithmeticOperator sumOperator= Die::PLUS;
+    };
+
+    bool compileChain(ExecutionNode* node, Operand& current);
+    bool compileNode(ExecutionNode* node, Operand& current);
+    bool toScalar(const Operand& operand, quint32& index);
+    quint32 addScalar();
+    quint32 addPool();
+
+    void execute();
+    void publish();
+    qreal poolScalar(const Pool& pool) const;
+    qint64 score(const Instruction& op, const Pool& pool, std::size_t i) const;
+
+    static bool readCondition(ValidatorList* list, Instruction& op);
+    static bool matches(quint8 mode, qint64 value, qint64 reference);
+
+private:
+    ExecutionNode* m_root= nullptr;
+    bool m_valid= false;
+    std::vector<Instruction> m_instructions;
+    std::vector<qreal> m_scalars;
+    std::vector<Pool> m_pools;
+    std::vector<quint32> m_active;
+    std::vector<quint32> m_nextActive;
+    QMap<Dice::ERROR_CODE, QString> m_errors;
+};
+
+#endif // DICEPROGRAM_H
@@ -21,67 +21,46 @@
  ***************************************************************************/
 
 #include "die.h"
+#include "executionbudget.h"
+#include "randomengine.h"
 
 #include <QDateTime>
 #include <QDebug>
-#include <QUuid>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 
-void Die::buildSeed()
-{
-    static bool init= false;
-    if(init)
-        return;
-    std::array<int, std::mt19937::state_size> seed_data;
-    std::random_device r;
-    std::generate_n(seed_data.data(), seed_data.size(), std::ref(r));
-    std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
-    s_rng= std::mt19937(seq);
-    init= true;
+namespace
+{
+std::atomic<quint64> s_lastUuid(0);
 }
 
-std::mt19937 Die::s_rng;
-
-Die::Die()
-    : m_uuid(QUuid::createUuid().toString(QUuid::WithoutBraces))
-    , m_hasValue(false)
-    , m_displayStatus(false)
-    , m_highlighted(true)
-    , m_base(1)
-    , m_color("")
-    , m_op(Die::PLUS) //,m_mt(m_randomDevice)
+Die::Die() : m_data(new Data), m_displayStatus(false), m_highlighted(true), m_color("")
 {
-    buildSeed();
+    m_data->uuid= s_lastUuid.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 Die::Die(const Die& die)
+    : m_data(die.m_data)
+    , m_selected(die.m_selected)
+    , m_displayStatus(die.m_displayStatus)
+    , m_highlighted(die.m_highlighted)
+    , m_color(die.m_color)
 {
-    m_value= die.m_value;
-    m_rollResult= die.m_rollResult;
-    m_selected= die.m_selected;
-    m_hasValue= die.m_hasValue;
-    m_uuid= die.m_uuid;
-    m_displayStatus= die.m_displayStatus;
-    m_maxValue= die.m_maxValue;
-    m_highlighted= die.m_highlighted;
-    m_base= die.m_base;
-    m_color= die.getColor();
-    m_op= die.getOp();
-    // auto seed= std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    // m_rng= std::mt19937(quintptr(this) + static_cast<unsigned long long>(seed));
 }
 
 void Die::setValue(qint64 r)
 {
-    m_value= r;
-    m_hasValue= true;
+    m_data->value= r;
+    m_data->hasValue= true;
 }
 
 void Die::insertRollValue(qint64 r)
 {
-    m_rollResult.append(r);
+    Data* data= m_data.data();
+    data->rollValue= data->rollResult.isEmpty() ? r : combine(data->op, data->rollValue, r);
+    data->rollResult.append(r);
 }
 
 void Die::setSelected(bool b)
@@ -95,76 +74,75 @@ bool Die::isSelected() const
 }
 qint64 Die::getValue() const
 {
-    if(m_hasValue)
-    {
-        return m_value;
-    }
-    else
+    return m_data->hasValue ? m_data->value : m_data->rollValue;
+}
+
+qint64 Die::combine(Die::ArithmeticOperator op, qint64 value, qint64 roll)
+{
+    switch(op)
     {
-        qint64 value= 0;
-        int i= 0;
-        for(qint64 tmp : m_rollResult)
+    case PLUS:
+        value+= roll;
+        break;
+    case MULTIPLICATION:
+        value*= roll;
+        break;
+    case MINUS:
+        value-= roll;
+        break;
+    case INTEGER_DIVIDE:
+    case DIVIDE:
+        if(roll != 0)
         {
-            if(i > 0)
-            {
-                switch(m_op)
-                {
-                case PLUS:
-                    value+= tmp;
-                    break;
-                case MULTIPLICATION:
-                    value*= tmp;
-                    break;
-                case MINUS:
-                    value-= tmp;
-                    break;
-                case INTEGER_DIVIDE:
-                case DIVIDE:
-                    if(tmp != 0)
-                    {
-                        value/= tmp;
-                    }
-                    else
-                    {
-                        // error();
-                    }
-                    break;
-                case POW:
-                    value= static_cast<qint64>(std::pow(value, tmp));
-                    break;
-                }
-            }
-            else
-            {
-                value= tmp;
-            }
-            ++i;
+            value/= roll;
         }
-        return value;
+        else
+        {
+            // error();
+        }
+        break;
+    case POW:
+        value= static_cast<qint64>(std::pow(value, roll));
+        break;
+    }
+    return value;
+}
+
+void Die::computeRollValue()
+{
+    Data* data= m_data.data();
+    data->rollValue= 0;
+    int i= 0;
+    for(qint64 tmp : data->rollResult)
+    {
+        data->rollValue= (i > 0) ? combine(data->op, data->rollValue, tmp) : tmp;
+        ++i;
     }
 }
 QList<qint64> Die::getListValue() const
 {
-    return m_rollResult;
+    return m_data->rollResult;
 }
 bool Die::hasChildrenValue()
 {
-    return m_rollResult.size() > 1 ? true : false;
+    return m_data.constData()->rollResult.size() > 1 ? true : false;
 }
 void Die::replaceLastValue(qint64 value)
 {
-    m_rollResult.removeLast();
+    m_data->rollResult.removeLast();
+    computeRollValue();
     insertRollValue(value);
 }
 
-void Die::roll(bool adding)
+void Die::roll(bool adding, RandomEngine* engine)
 {
-    if(m_maxValue != 0)
+    // reading the range must not clone shared data: only the new roll does.
+    const Data* data= m_data.constData();
+    if(data->maxValue != 0 && ExecutionBudget::allowRolls(1))
     {
-        // quint64 value=(qrand()%m_faces)+m_base;
-        std::uniform_int_distribution<qint64> dist(m_base, m_maxValue);
-        qint64 value= dist(s_rng);
-        if((adding) || (m_rollResult.isEmpty()))
+        engine= RandomEngine::select(engine);
+        qint64 value= engine->bounded(data->base, data->maxValue);
+        if((adding) || (data->rollResult.isEmpty()))
         {
             insertRollValue(value);
         }
@@ -177,13 +155,14 @@ void Die::roll(bool adding)
 
 quint64 Die::getFaces() const
 {
-    return std::abs(m_maxValue - m_base) + 1;
+    return std::abs(m_data->maxValue - m_data->base) + 1;
 }
 qint64 Die::getLastRolledValue()
 {
-    if(!m_rollResult.isEmpty())
+    const Data* data= m_data.constData();
+    if(!data->rollResult.isEmpty())
     {
-        return m_rollResult.last();
+        return data->rollResult.last();
     }
     else
         return 0;
@@ -211,11 +190,11 @@ bool Die::isHighlighted() const
 }
 void Die::setBase(qint64 base)
 {
-    m_base= base;
+    m_data->base= base;
 }
 qint64 Die::getBase()
 {
-    return m_base;
+    return m_data.constData()->base;
 }
 QString Die::getColor() const
 {
@@ -229,29 +208,35 @@ void Die::setColor(const QString& color)
 
 qint64 Die::getMaxValue() const
 {
-    return m_maxValue;
+    return m_data->maxValue;
 }
 
 void Die::setMaxValue(const qint64& maxValue)
 {
-    m_maxValue= maxValue;
+    m_data->maxValue= maxValue;
 }
 
 Die::ArithmeticOperator Die::getOp() const
 {
-    return m_op;
+    return m_data->op;
 }
 
 void Die::setOp(const Die::ArithmeticOperator& op)
 {
-    m_op= op;
+    m_data->op= op;
+    computeRollValue();
+}
+quint64 Die::getUuid() const
+{
+    return m_data->uuid;
 }
-QString Die::getUuid() const
+
+void Die::setUuid(quint64 uuid)
 {
-    return m_uuid;
+    m_data->uuid= uuid;
 }
 
-void Die::setUuid(const QString& uuid)
+quint64 Die::reserveUuids(quint64 count)
 {
-    m_uuid= uuid;
+    return s_lastUuid.fetch_add(count, std::memory_order_relaxed) + 1;
 }
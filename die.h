@@ -23,13 +23,22 @@
 #define DIE_H
 
 #include <QList>
+#include <QSharedData>
+#include <QSharedDataPointer>
 #include <QString>
-#include <random>
+
+#include "dicearena.h"
+
+class RandomEngine;
 /**
  * @brief The Die class implements all methods required from a die. You must set the Faces first, then you can roll it
  * and roll it again, to add or replace the previous result.
+ *
+ * What the die rolled is shared by its copies and only cloned when one of them changes it (copy on write). Selection,
+ * highlight, display state and color belong to each copy: nodes copy the dice they get, so each one has its own view
+ * of them.
  */
-class Die
+class Die : public ArenaObject
 {
 public:
     /**
@@ -91,8 +100,9 @@ public:
     /**
      * @brief roll
      * @param adding
+     * @param engine source of randomness, the engine of the current thread is used when null.
      */
-    void roll(bool adding= false);
+    void roll(bool adding= false, RandomEngine* engine= nullptr);
     /**
      * @brief replaceLastValue
      * @param value
@@ -144,26 +154,44 @@ public:
     void setOp(const Die::ArithmeticOperator& op);
     void setDisplayed(bool b);
 
-    QString getUuid() const;
-    void setUuid(const QString& uuid);
+    /**
+     * @brief getUuid
+     * @return identity of the die, copies of a die share it.
+     */
+    quint64 getUuid() const;
+    void setUuid(quint64 uuid);
+    /**
+     * @brief reserveUuids
+     * @return first of count consecutive identities nobody else will get.
+     */
+    static quint64 reserveUuids(quint64 count);
+    /**
+     * @brief combine
+     * @return value once roll has been applied to it with the operator op.
+     */
+    static qint64 combine(Die::ArithmeticOperator op, qint64 value, qint64 roll);
 
-    static void buildSeed();
+private:
+    void computeRollValue();
 
 private:
-    QString m_uuid;
-    qint64 m_value= 0;
-    QList<qint64> m_rollResult;
+    struct Data : public QSharedData, public ArenaObject
+    {
+        quint64 uuid= 0;
+        qint64 value= 0;
+        QList<qint64> rollResult;
+        qint64 rollValue= 0; /// aggregate of rollResult, kept up to date by every change.
+        bool hasValue= false;
+        qint64 maxValue= 0;
+        qint64 base= 1;
+        Die::ArithmeticOperator op= Die::PLUS;
+    };
+
+    QSharedDataPointer<Data> m_data;
     bool m_selected= false;
-    bool m_hasValue= false;
     bool m_displayStatus= false;
     bool m_highlighted= true;
-    qint64 m_maxValue= 0;
-    qint64 m_base= 0;
     QString m_color;
-
-    Die::ArithmeticOperator m_op;
-
-    static std::mt19937 s_rng;
 };
 
 #endif // DIE_H
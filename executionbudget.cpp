@@ -0,0 +1,201 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "executionbudget.h"
+
+#include <QObject>
+
+namespace
+{
+thread_local ExecutionBudget* currentBudget= nullptr;
+// rolls are counted one by one in loops: the clock is only read every few of them.
+constexpr quint64 clockPeriod= 64;
+} // namespace
+
+ExecutionBudget::ExecutionBudget()
+    : m_dice(0), m_rolls(0), m_start(std::chrono::steady_clock::now()), m_cancelled(false), m_status(Status::Running)
+{
+}
+
+void ExecutionBudget::setMaxDice(quint64 count)
+{
+    m_maxDice= count;
+}
+
+quint64 ExecutionBudget::maxDice() const
+{
+    return m_maxDice;
+}
+
+void ExecutionBudget::setMaxRolls(quint64 count)
+{
+    m_maxRolls= count;
+}
+
+quint64 ExecutionBudget::maxRolls() const
+{
+    return m_maxRolls;
+}
+
+void ExecutionBudget::setMaxDuration(qint64 msec)
+{
+    m_maxDuration= msec;
+}
+
+qint64 ExecutionBudget::maxDuration() const
+{
+    return m_maxDuration;
+}
+
+void ExecutionBudget::cancel()
+{
+    m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+void ExecutionBudget::clearCancel()
+{
+    m_cancelled.store(false, std::memory_order_relaxed);
+}
+
+bool ExecutionBudget::isCancelled() const
+{
+    return m_cancelled.load(std::memory_order_relaxed);
+}
+
+void ExecutionBudget::start()
+{
+    m_dice.store(0, std::memory_order_relaxed);
+    m_rolls.store(0, std::memory_order_relaxed);
+    m_status.store(Status::Running, std::memory_order_relaxed);
+    m_start= std::chrono::steady_clock::now();
+}
+
+ExecutionBudget::Status ExecutionBudget::status() const
+{
+    return m_status.load(std::memory_order_relaxed);
+}
+
+bool ExecutionBudget::isExhausted() const
+{
+    return Status::Running != status();
+}
+
+quint64 ExecutionBudget::diceCount() const
+{
+    return m_dice.load(std::memory_order_relaxed);
+}
+
+quint64 ExecutionBudget::rollCount() const
+{
+    return m_rolls.load(std::memory_order_relaxed);
+}
+
+Dice::ERROR_CODE ExecutionBudget::errorCode() const
+{
+    return Status::Cancelled == status() ? Dice::ERROR_CODE::EXECUTION_CANCELLED :
+                                           Dice::ERROR_CODE::EXECUTION_BUDGET_EXCEEDED;
+}
+
+QString ExecutionBudget::errorMessage() const
+{
+    switch(status())
+    {
+    case Status::TooManyDice:
+        return QObject::tr("Execution stopped: more than %1 dice").arg(m_maxDice);
+    case Status::TooManyRolls:
+        return QObject::tr("Execution stopped: more than %1 rolls").arg(m_maxRolls);
+    case Status::TimeOut:
+        return QObject::tr("Execution stopped: it took more than %1 ms").arg(m_maxDuration);
+    case Status::Cancelled:
+        return QObject::tr("Execution cancelled");
+    case Status::Running:
+        break;
+    }
+    return {};
+}
+
+bool ExecutionBudget::check()
+{
+    if(Status::Running != status())
+        return false;
+
+    if(m_cancelled.load(std::memory_order_relaxed))
+        stop(Status::Cancelled);
+    else if(m_maxDuration > 0
+            && std::chrono::steady_clock::now() - m_start > std::chrono::milliseconds(m_maxDuration))
+        stop(Status::TimeOut);
+
+    return Status::Running == status();
+}
+
+void ExecutionBudget::stop(Status reason)
+{
+    // the first reason found is kept.
+    auto running= Status::Running;
+    m_status.compare_exchange_strong(running, reason, std::memory_order_relaxed);
+}
+
+ExecutionBudget* ExecutionBudget::setCurrent(ExecutionBudget* budget)
+{
+    auto previous= currentBudget;
+    currentBudget= budget;
+    return previous;
+}
+
+ExecutionBudget* ExecutionBudget::current()
+{
+    return currentBudget;
+}
+
+bool ExecutionBudget::allowDice(quint64 count)
+{
+    auto budget= currentBudget;
+    if(nullptr == budget)
+        return true;
+
+    auto dice= budget->m_dice.fetch_add(count, std::memory_order_relaxed) + count;
+    if(budget->m_maxDice > 0 && dice > budget->m_maxDice)
+        budget->stop(Status::TooManyDice);
+    return budget->check();
+}
+
+bool ExecutionBudget::allowRolls(quint64 count)
+{
+    auto budget= currentBudget;
+    if(nullptr == budget)
+        return true;
+
+    auto before= budget->m_rolls.fetch_add(count, std::memory_order_relaxed);
+    auto rolls= before + count;
+    if(budget->m_maxRolls > 0 && rolls > budget->m_maxRolls)
+        budget->stop(Status::TooManyRolls);
+    if(Status::Running != budget->status())
+        return false;
+    if(before / clockPeriod == rolls / clockPeriod)
+        return true;
+    return budget->check();
+}
+
+bool ExecutionBudget::interrupted()
+{
+    auto budget= currentBudget;
+    return nullptr != budget && !budget->check();
+}
@@ -20,7 +20,7 @@
 #include "include/highlightdice.h"
 
 HighLightDice::HighLightDice(QList<qint64> result, bool isHighlighted, QString color, bool displayed, quint64 faces,
-                             const QString& uuid)
+                             quint64 uuid)
     : m_result(result)
     , m_hasHighlight(isHighlighted)
     , m_color(color)
@@ -99,12 +99,12 @@ QString HighLightDice::getResultString() const
     }
 }
 
-QString HighLightDice::uuid() const
+quint64 HighLightDice::uuid() const
 {
     return m_uuid;
 }
 
-void HighLightDice::setUuid(const QString& uuid)
+void HighLightDice::setUuid(quint64 uuid)
 {
     m_uuid= uuid;
 }
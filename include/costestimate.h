@@ -0,0 +1,93 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef COSTESTIMATE_H
+#define COSTESTIMATE_H
+
+#include <QtGlobal>
+#include <vector>
+
+class ExecutionBudget;
+class ExecutionNode;
+
+/**
+ * @brief The CostEstimate class is the cost of parsed instructions, computed from their tree without running them:
+ * dice created, rolls, loop turns and values given back. Expected costs come from the face ranges and the share of
+ * faces matching each condition. For random loops, the worst cost is the one exceeded with a probability below one in
+ * a million for each die. A loop which never ends makes the worst costs infinite.
+ */
+class CostEstimate
+{
+public:
+    struct Measure
+    {
+        qreal expected= 0.0;
+        qreal worst= 0.0;
+    };
+
+    CostEstimate();
+    /**
+     * @brief estimate
+     * @return cost of running the given instructions once.
+     */
+    static CostEstimate estimate(const std::vector<ExecutionNode*>& instructions);
+
+    /**
+     * @brief dice
+     * @return dice created by roll operators and value lists.
+     */
+    const Measure& dice() const;
+    /**
+     * @brief rolls
+     * @return values drawn from the random engine.
+     */
+    const Measure& rolls() const;
+    /**
+     * @brief iterations
+     * @return turns of loops: explosions, rerolls, all-same passes, group search and repeat.
+     */
+    const Measure& iterations() const;
+    /**
+     * @brief output
+     * @return values held by the final results of the instructions.
+     */
+    const Measure& output() const;
+    bool isEndless() const;
+    /**
+     * @brief fits
+     * @return true if the worst dice and rolls stay within the limits of budget.
+     */
+    bool fits(const ExecutionBudget& budget) const;
+
+private:
+    class Walker;
+
+    void add(const CostEstimate& other, qreal expected, qreal worst);
+
+private:
+    Measure m_dice;
+    Measure m_rolls;
+    Measure m_iterations;
+    Measure m_output;
+    bool m_endless= false;
+};
+
+#endif // COSTESTIMATE_H
@@ -22,6 +22,7 @@
 #ifndef DICEALIAS_H
 #define DICEALIAS_H
 
+#include <QRegularExpression>
 #include <QString>
 /**
  * @brief The DiceAlias class is dedicated to store aliases, alias is mainly two QString. The Alias and its replacement.
@@ -109,12 +110,19 @@ public:
      */
     void setComment(const QString& comment);
 
+private:
+    /**
+     * @brief compileExpression builds the regular expression once, instead of at each resolution.
+     */
+    void compileExpression();
+
 private:
     QString m_command;
     QString m_value;
     QString m_comment;
     RESOLUTION_TYPE m_type;
     bool m_isEnable;
+    QRegularExpression m_expression;
 };
 
 #endif // DICEALIAS_H
@@ -29,15 +29,25 @@
 #include <memory>
 #include <vector>
 
+#include "costestimate.h"
 #include "diceparserhelper.h"
+#include "executionbudget.h"
 #include "highlightdice.h"
+#include "outputcache.h"
+#include "preparedcommand.h"
 //#include "node/executionnode.h"
 
 class ExplodeDiceNode;
 class ParsingToolBox;
 class DiceRollerNode;
 class DiceAlias;
+class DiceArena;
+class DiceProgram;
 class ExecutionNode;
+class RandomEngine;
+class TapePlayerEngine;
+class TapeRecorderEngine;
+struct RollTape;
 /**
  * @page DiceParser Dice Parser
  *
@@ -72,9 +82,110 @@ public:
      * @return bool every thing is fine or not
      */
     bool parseLine(QString str, bool allowAlias= true);
+    /**
+     * @brief start runs the parsed command. Instructions which depend on none of each other and draw from their own
+     * random streams (PHILOX engine) run in parallel on the global thread pool, with the results of a sequential run.
+     * Only PHILOX gives streams: with MT19937 (the default), XOSHIRO256, a roll tape or a prepared command, every
+     * instruction rolling dice draws from the one engine of the parser, so they run one after the other.
+     */
     void start();
     void cleanAll();
 
+    // prepared commands
+    /**
+     * @brief prepare parses the command once and keeps it as a plan. The plan does not depend on this parser: it can
+     * be started any number of times, by any parser, from any thread.
+     */
+    PreparedCommand prepare(QString str, bool allowAlias= true);
+    /**
+     * @brief start runs a fresh copy of the prepared plan with the engine of this parser. Results are read with the
+     * usual accessors, until the next call to parseLine or start.
+     * @return false if the plan is not valid.
+     */
+    bool start(const PreparedCommand& command);
+    /**
+     * @brief setPlanCacheSize makes parseLine and prepare keep up to size plans, keyed by the alias-expanded command.
+     * 0 (the default) disables the cache. Plans are dropped when aliases, variables or the help path change.
+     */
+    void setPlanCacheSize(int size);
+    int planCacheSize() const;
+    int cachedPlanCount() const;
+    void clearPlanCache();
+
+    // pure commands
+    /**
+     * @brief isPure
+     * @return true if the parsed command draws no random value (arithmetic, strings, help, aliases, lists without
+     * roll): each execution gives the same output.
+     */
+    bool isPure() const;
+    /**
+     * @brief setOutputCacheSize makes storeOutput keep up to size outputs of pure commands. 0 (the default) disables
+     * the cache. Outputs are dropped when aliases, variables or the help path change.
+     */
+    void setOutputCacheSize(int size);
+    int outputCacheSize() const;
+    int cachedOutputCount() const;
+    void clearOutputCache();
+    /**
+     * @brief cachedOutput
+     * @return output given to storeOutput for the command in the named format, or a null string. The command is
+     * neither parsed nor run.
+     */
+    QString cachedOutput(QString command, const QString& format, bool allowAlias= true);
+    /**
+     * @brief storeOutput keeps output, formatted by the caller in the named format, as the output of the command last
+     * given to parseLine, if it is pure.
+     */
+    void storeOutput(const QString& format, const QString& output);
+
+    // memory
+    /**
+     * @brief setArenaEnabled chooses whether the nodes, results and dice of the following commands come from an arena
+     * owned by this parser (the default), given back at once when the next command is parsed, or from the heap.
+     */
+    void setArenaEnabled(bool enabled);
+    bool isArenaEnabled() const;
+
+    // optimization
+    /**
+     * @brief setConstantFoldingEnabled chooses whether the dice-free parts of the following commands, such as 2+3 in
+     * (2+3)d6, are computed once when parsing (the default) or at each execution.
+     */
+    void setConstantFoldingEnabled(bool enabled);
+    bool isConstantFoldingEnabled() const;
+    /**
+     * @brief foldedConstantCount
+     * @return number of parts of the last parsed command replaced by a constant, 0 for a command from the plan cache.
+     */
+    int foldedConstantCount() const;
+
+    // execution
+    /**
+     * @brief setBytecodeEnabled makes start() run each instruction of the command on the bytecode interpreter when it
+     * can be compiled. The other instructions, and all of them when disabled (the default), run on the execution tree.
+     */
+    void setBytecodeEnabled(bool enabled);
+    bool isBytecodeEnabled() const;
+    /**
+     * @brief compiledInstructionCount
+     * @return number of instructions of the command run by the bytecode interpreter.
+     */
+    int compiledInstructionCount() const;
+    /**
+     * @brief executionBudget bounds each execution (start()) of this parser. Limits are set between executions,
+     * cancel() may be called from any thread, and stops executions until clearCancel(). A broken budget is reported by
+     * errorMap().
+     */
+    ExecutionBudget& executionBudget();
+    const ExecutionBudget& executionBudget() const;
+    /**
+     * @brief estimateCost
+     * @return cost of running the parsed command, computed from its tree before start() so expensive commands can be
+     * rejected or queued.
+     */
+    CostEstimate estimateCost() const;
+
     // debug
     void writeDownDotTree(QString filepath);
 
@@ -92,7 +203,6 @@ public:
     QString convertAlias(const QString& cmd) const;
 
     QStringList allFirstResultAsString(bool& hasAlias);
-    QStringList getAllDiceResult(bool& hasAlias);
 
     // Accessors
     int startNodeCount() const;
@@ -118,12 +228,65 @@ public:
     void setVariableDictionary(const QHash<QString, QString>& variables);
     void setComment(const QString& comment);
 
+    // randomness
+    /**
+     * @brief setRandomEngine replaces the engine used by the next parsed commands.
+     */
+    void setRandomEngine(Dice::RANDOM_ENGINE type);
+    /**
+     * @brief setSeed makes the following rolls reproducible.
+     */
+    void setSeed(quint64 seed);
+    RandomEngine* randomEngine() const;
+
+    // roll tape
+    /**
+     * @brief startRecording keeps the raw draws of each execution (start()) of the next parsed commands.
+     */
+    void startRecording();
+    /**
+     * @brief startReplay makes the next parsed commands draw from the tape instead of the engine, from its
+     * beginning at each execution.
+     */
+    void startReplay(const RollTape& tape);
+    void stopRollTape();
+    /**
+     * @brief rollTape
+     * @return draws of the last execution while recording, the replayed tape while replaying.
+     */
+    RollTape rollTape() const;
+    bool isReplayExhausted() const;
+
 private:
     bool readBlocInstruction(QString& str, ExecutionNode*& resultnode);
+    void updateRandomEngine();
+    void releasePreparedNodes();
+    void resetArena();
+    bool parseCommand(QString str);
+    PreparedCommand parsePlan(const QString& str, bool* parsed= nullptr);
+    void loadPrepared(const PreparedCommand& command);
+    void checkPlanCache();
+    void compilePrograms();
 
 private:
     std::unique_ptr<ParsingToolBox> m_parsingToolbox;
     QString m_command;
+    std::shared_ptr<RandomEngine> m_randomEngine;
+    std::shared_ptr<TapeRecorderEngine> m_tapeRecorder;
+    std::shared_ptr<TapePlayerEngine> m_tapePlayer;
+    std::vector<ExecutionNode*> m_preparedNodes;
+    std::unique_ptr<DiceArena> m_arena;
+    std::vector<std::unique_ptr<DiceArena>> m_workerArenas;
+    mutable PreparedCommandCache m_planCache;
+    mutable OutputCache m_outputCache;
+    QString m_outputKey;
+    bool m_pure= false;
+    quint64 m_planVariableGeneration= 0;
+    bool m_constantFoldingEnabled= true;
+    int m_foldedConstantCount= 0;
+    bool m_bytecodeEnabled= false;
+    ExecutionBudget m_budget;
+    std::vector<std::unique_ptr<DiceProgram>> m_programs;
 };
 
 #endif // DICEPARSER_H
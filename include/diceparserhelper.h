@@ -26,7 +26,9 @@ enum class ERROR_CODE : int
     INVALID_INDEX,
     UNEXPECTED_CHARACTER,
     NO_PREVIOUS_ERROR,
-    NO_VALID_RESULT
+    NO_VALID_RESULT,
+    EXECUTION_BUDGET_EXCEEDED,
+    EXECUTION_CANCELLED
 };
 
 /**
@@ -39,6 +41,15 @@ enum class RESULT_TYPE : int
     STRING= 2,
     DICE_LIST= 4
 };
+/**
+ * @brief The RANDOM_ENGINE enum lists the available random generators
+ */
+enum class RANDOM_ENGINE : int
+{
+    MT19937,
+    XOSHIRO256,
+    PHILOX
+};
 /**
  * @brief The ConditionType enum defines compare method
  */
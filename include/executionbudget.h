@@ -0,0 +1,121 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef EXECUTIONBUDGET_H
+#define EXECUTIONBUDGET_H
+
+#include <QString>
+#include <atomic>
+#include <chrono>
+
+#include "diceparserhelper.h"
+
+/**
+ * @brief The ExecutionBudget class bounds one execution of a command: dice created by roll operators, rolls and wall
+ * time. Looping operators check it at each turn and stop once it is broken, so a single command can not stall the
+ * thread running it. 0 means no limit, which is the default. Threads helping the same execution share its counters.
+ */
+class ExecutionBudget
+{
+public:
+    enum class Status : quint8
+    {
+        Running,
+        TooManyDice,
+        TooManyRolls,
+        TimeOut,
+        Cancelled
+    };
+
+    ExecutionBudget();
+
+    void setMaxDice(quint64 count);
+    quint64 maxDice() const;
+    void setMaxRolls(quint64 count);
+    quint64 maxRolls() const;
+    /**
+     * @brief setMaxDuration sets the wall time, in milliseconds, given to each execution.
+     */
+    void setMaxDuration(qint64 msec);
+    qint64 maxDuration() const;
+
+    /**
+     * @brief cancel stops the running execution at its next check, or the next execution if none is running. It can
+     * be called from any thread. The cancellation lasts until clearCancel(), so an execution starting at the same
+     * time can not miss it.
+     */
+    void cancel();
+    void clearCancel();
+    bool isCancelled() const;
+
+    /**
+     * @brief start resets the counters and the clock before an execution. A pending cancellation is kept.
+     */
+    void start();
+    Status status() const;
+    /**
+     * @brief isExhausted
+     * @return true if the last execution has been stopped.
+     */
+    bool isExhausted() const;
+    quint64 diceCount() const;
+    quint64 rollCount() const;
+    Dice::ERROR_CODE errorCode() const;
+    QString errorMessage() const;
+
+    /**
+     * @brief setCurrent makes the given budget bound the executions of the calling thread, nullptr removes any bound.
+     * @return previous budget.
+     */
+    static ExecutionBudget* setCurrent(ExecutionBudget* budget);
+    static ExecutionBudget* current();
+    /**
+     * @brief allowDice records count dice about to be created by the current execution.
+     * @return false once the execution has to stop.
+     */
+    static bool allowDice(quint64 count);
+    /**
+     * @brief allowRolls records count rolls about to be made by the current execution.
+     * @return false once the execution has to stop.
+     */
+    static bool allowRolls(quint64 count);
+    /**
+     * @brief interrupted
+     * @return true once the current execution has broken its budget or has been cancelled.
+     */
+    static bool interrupted();
+
+private:
+    bool check();
+    void stop(Status reason);
+
+private:
+    quint64 m_maxDice= 0;
+    quint64 m_maxRolls= 0;
+    qint64 m_maxDuration= 0;
+    std::atomic<quint64> m_dice;
+    std::atomic<quint64> m_rolls;
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<bool> m_cancelled;
+    std::atomic<Status> m_status;
+};
+
+#endif // EXECUTIONBUDGET_H
@@ -28,7 +28,7 @@ class HighLightDice
 {
 public:
     HighLightDice(QList<qint64> result, bool isHighlighted, QString color, bool displayed, quint64 faces,
-                  const QString& uuid);
+                  quint64 uuid);
     virtual ~HighLightDice();
 
     QList<qint64> result() const;
@@ -48,8 +48,8 @@ public:
 
     QString getResultString() const;
 
-    QString uuid() const;
-    void setUuid(const QString& uuid);
+    quint64 uuid() const;
+    void setUuid(quint64 uuid);
 
 private:
     QList<qint64> m_result;
@@ -57,7 +57,7 @@ private:
     QString m_color;
     bool m_displayed= false;
     quint64 m_faces;
-    QString m_uuid;
+    quint64 m_uuid;
 };
 
 typedef QList<HighLightDice> ListDiceResult;
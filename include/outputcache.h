@@ -0,0 +1,63 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef OUTPUTCACHE_H
+#define OUTPUTCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <list>
+#include <utility>
+
+/**
+ * @brief The OutputCache class keeps the most recently used formatted outputs of pure commands, up to its capacity.
+ * An output is keyed by the command and the name of its format, chosen by the caller (json, html, irc...). A capacity
+ * of 0 disables it.
+ */
+class OutputCache
+{
+public:
+    explicit OutputCache(int capacity= 0);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int size() const;
+    void clear();
+
+    /**
+     * @brief find
+     * @return cached output of the command in the format, or a null string. A found output becomes the most recently
+     * used.
+     */
+    QString find(const QString& command, const QString& format);
+    void insert(const QString& command, const QString& format, const QString& output);
+
+private:
+    static QString key(const QString& command, const QString& format);
+
+private:
+    using Entry= std::pair<QString, QString>;
+    std::list<Entry> m_entries;
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    int m_capacity;
+};
+
+#endif // OUTPUTCACHE_H
@@ -24,6 +24,7 @@
 
 #include <QMap>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "booleancondition.h"
@@ -40,6 +41,7 @@
 class RepeaterNode;
 class DiceAlias;
 class ExplodeDiceNode;
+class RandomEngine;
 
 class SubtituteInfo
 {
@@ -193,7 +195,13 @@ public:
     static QString number(qreal value);
     static ExecutionNode* getLatestNode(ExecutionNode* node);
     static ExecutionNode* getLeafNode(ExecutionNode* start);
+    /**
+     * @brief isPure
+     * @return true if no node of the instructions draws a random value: each run gives the same results.
+     */
+    static bool isPure(const std::vector<ExecutionNode*>& instructions);
     const std::vector<ExecutionNode*>& getStartNodes();
+    std::vector<ExecutionNode*>* getStartNodeList();
     static void setStartNodes(std::vector<ExecutionNode*>* startNodes);
     std::pair<bool, QVariant> hasResultOfType(Dice::RESULT_TYPE, ExecutionNode* node, bool notthelast= false) const;
     QList<qreal> scalarResultsFromEachInstruction() const;
@@ -225,8 +233,20 @@ public:
     void setComment(const QString& comment);
     QString getComment() const;
     void setHelpPath(const QString& path);
+    std::shared_ptr<RandomEngine> getRandomEngine() const;
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    /**
+     * @brief nodeRandomEngine
+     * @return engine for the next rolling node: its own stream with counter-based engines, the shared one otherwise.
+     */
+    std::shared_ptr<RandomEngine> nodeRandomEngine();
     static QHash<QString, QString> getVariableHash();
     static void setVariableHash(const QHash<QString, QString>& variableHash);
+    /**
+     * @brief variableHashGeneration
+     * @return number of changes of the variable dictionary, which is read while parsing.
+     */
+    static quint64 variableHashGeneration();
     void setStartNodes(std::vector<ExecutionNode*> nodes);
 
     // Aliases
@@ -240,16 +260,6 @@ public:
     static QString replacePlaceHolderFromJson(const QString& source, const QJsonObject& obj);
 
 private:
-    QMap<QString, BooleanCondition::LogicOperator> m_logicOp;
-    QMap<QString, ValidatorList::LogicOperation> m_logicOperation;
-    QMap<QString, OperationCondition::ConditionOperator> m_conditionOperation;
-    std::vector<std::pair<QString, Die::ArithmeticOperator>> m_arithmeticOperation;
-    QMap<QString, DiceOperator> m_mapDiceOp;
-    QMap<QString, OptionOperator> m_OptionOp;
-    QMap<QString, NodeAction> m_nodeActionMap;
-    std::map<QString, Function> m_functionMap;
-    QStringList m_commandList;
-
     QMap<Dice::ERROR_CODE, QString> m_errorMap;
     QMap<Dice::ERROR_CODE, QString> m_warningMap;
     std::vector<ExecutionNode*> m_startNodes;
@@ -259,6 +269,9 @@ private:
     static QHash<QString, QString> m_variableHash;
     QString m_helpPath;
     QList<DiceAlias*> m_aliasList;
+    std::shared_ptr<RandomEngine> m_randomEngine;
+    quint32 m_instructionIndex= 0;
+    quint32 m_rollingNodeIndex= 0;
 };
 
 #endif // PARSINGTOOLBOX_H
@@ -0,0 +1,111 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef PREPAREDCOMMAND_H
+#define PREPAREDCOMMAND_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "diceparserhelper.h"
+
+class ExecutionNode;
+
+/**
+ * @brief The PreparedCommand class is the parsed plan of a command, built once by DiceParser::prepare. The plan is
+ * never run itself: each execution works on its own copy, so one PreparedCommand can be started any number of times,
+ * by several parsers, from several threads.
+ */
+class PreparedCommand
+{
+public:
+    PreparedCommand();
+
+    bool isValid() const;
+    QString command() const;
+    QString comment() const;
+    int instructionCount() const;
+    const QMap<Dice::ERROR_CODE, QString>& errorMap() const;
+    const QMap<Dice::ERROR_CODE, QString>& warningMap() const;
+
+    /**
+     * @brief instantiate fills startNodes with a fresh execution tree of the plan. Instructions referring to others
+     * ($n, m, b) refer to startNodes. The caller owns the new nodes.
+     */
+    void instantiate(std::vector<ExecutionNode*>& startNodes) const;
+
+private:
+    friend class DiceParser;
+    struct Plan;
+    /**
+     * @brief build copies the freshly parsed instructions into a new plan. parsed stays owned by the caller. The plan
+     * is left empty, hence invalid, if a node could not be copied as a whole.
+     */
+    static PreparedCommand build(const QString& command, const QString& comment,
+                                 const QMap<Dice::ERROR_CODE, QString>& errors,
+                                 const QMap<Dice::ERROR_CODE, QString>& warnings,
+                                 const std::vector<ExecutionNode*>& parsed);
+
+private:
+    std::shared_ptr<const Plan> m_plan;
+};
+
+/**
+ * @brief The PreparedCommandCache class keeps the most recently used plans, up to its capacity. A capacity of 0
+ * disables it.
+ */
+class PreparedCommandCache
+{
+public:
+    explicit PreparedCommandCache(int capacity= 0);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int size() const;
+    void clear();
+
+    /**
+     * @brief find
+     * @return cached plan of the key, or an invalid one. A found plan becomes the most recently used.
+     */
+    PreparedCommand find(const QString& key);
+    void insert(const QString& key, const PreparedCommand& command);
+
+    /**
+     * @brief normalize
+     * @return cache key of an alias-expanded command: the dice operator is folded to lower case outside of strings,
+     * lists, variables and comment, as the parser does not make the difference.
+     */
+    static QString normalize(const QString& command);
+
+private:
+    using Entry= std::pair<QString, PreparedCommand>;
+    std::list<Entry> m_entries;
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    int m_capacity;
+};
+
+#endif // PREPAREDCOMMAND_H
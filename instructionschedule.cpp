@@ -0,0 +1,354 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "instructionschedule.h"
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+#include "booleancondition.h"
+#include "executionbudget.h"
+#include "node/allsamenode.h"
+#include "node/bind.h"
+#include "node/countexecutenode.h"
+#include "node/dicerollernode.h"
+#include "node/explodedicenode.h"
+#include "node/filternode.h"
+#include "node/ifnode.h"
+#include "node/listsetrollnode.h"
+#include "node/mergenode.h"
+#include "node/occurencecountnode.h"
+#include "node/parenthesesnode.h"
+#include "node/repeaternode.h"
+#include "node/rerolldicenode.h"
+#include "node/scalaroperatornode.h"
+#include "node/valueslistnode.h"
+#include "node/variablenode.h"
+#include "operationcondition.h"
+#include "randomengine.h"
+#include "validatorlist.h"
+
+namespace
+{
+/**
+ * @brief The Usage struct is what one instruction shares with the others.
+ */
+struct Usage
+{
+    std::set<std::size_t> variables; /// instructions read through $n
+    bool sharedEngine= false;        /// draws from an engine other nodes draw from too
+    bool entangled= false;           /// reads or relinks all the instructions
+};
+
+/**
+ * @brief The Level struct holds one level of a schedule, shared by the threads running it.
+ */
+struct Level
+{
+    const std::vector<std::size_t>* instructions= nullptr;
+    const InstructionSchedule::Task* task= nullptr;
+    ExecutionBudget* budget= nullptr;
+    std::atomic<std::size_t> next;
+};
+
+void runLevel(Level& level, int worker)
+{
+    auto previousBudget= ExecutionBudget::setCurrent(level.budget);
+    auto count= level.instructions->size();
+    for(auto i= level.next++; i < count && !ExecutionBudget::interrupted(); i= level.next++)
+        (*level.task)((*level.instructions)[i], worker);
+    ExecutionBudget::setCurrent(previousBudget);
+}
+
+class LevelTask : public QRunnable
+{
+public:
+    LevelTask(Level& level, int worker, QSemaphore& finished) : m_level(level), m_worker(worker), m_finished(finished)
+    {
+    }
+    void run() override
+    {
+        runLevel(m_level, m_worker);
+        m_finished.release();
+    }
+
+private:
+    Level& m_level;
+    int m_worker;
+    QSemaphore& m_finished;
+};
+} // namespace
+
+/**
+ * @brief The InstructionSchedule::Walker class follows the nodes of one instruction, internal ones included, and
+ * records what the instruction shares with the others.
+ */
+class InstructionSchedule::Walker
+{
+public:
+    explicit Walker(Usage& usage) : m_usage(usage) {}
+
+    void chain(ExecutionNode* node)
+    {
+        // a node already run may have been linked to a branch which is also walked on its own.
+        for(; nullptr != node && m_visited.insert(node).second; node= node->getNextNode())
+            step(node);
+    }
+
+private:
+    void step(ExecutionNode* node)
+    {
+        if(auto variable= dynamic_cast<VariableNode*>(node))
+        {
+            m_usage.variables.insert(static_cast<std::size_t>(variable->getIndex()));
+        }
+        else if(auto roller= dynamic_cast<DiceRollerNode*>(node))
+        {
+            engine(roller->getRandomEngine());
+        }
+        else if(auto explode= dynamic_cast<ExplodeDiceNode*>(node))
+        {
+            engine(explode->getRandomEngine());
+            validators(explode->getValidatorList());
+        }
+        else if(auto reroll= dynamic_cast<RerollDiceNode*>(node))
+        {
+            engine(reroll->getRandomEngine());
+            chain(reroll->getInstruction());
+            validators(reroll->getValidatorList());
+        }
+        else if(auto allSame= dynamic_cast<AllSameNode*>(node))
+        {
+            engine(allSame->getRandomEngine());
+        }
+        else if(auto list= dynamic_cast<ListSetRollNode*>(node))
+        {
+            engine(list->getRandomEngine());
+        }
+        else if(dynamic_cast<MergeNode*>(node) || dynamic_cast<BindNode*>(node))
+        {
+            m_usage.entangled= true;
+        }
+        else if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+        {
+            chain(operation->getInternalNode());
+        }
+        else if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+        {
+            chain(parentheses->getInternalNode());
+        }
+        else if(auto repeater= dynamic_cast<RepeaterNode*>(node))
+        {
+            // turns are seeded by a draw of the engine of the parser.
+            m_usage.sharedEngine= true;
+            chain(repeater->getTimeNode());
+            for(auto command : repeater->getCommand())
+                chain(command);
+        }
+        else if(auto condition= dynamic_cast<IfNode*>(node))
+        {
+            chain(condition->getInstructionTrue());
+            chain(condition->getInstructionFalse());
+            validators(condition->getValidatorList());
+        }
+        else if(auto values= dynamic_cast<ValuesListNode*>(node))
+        {
+            for(auto value : values->getValues())
+                chain(value);
+        }
+        else if(auto count= dynamic_cast<CountExecuteNode*>(node))
+        {
+            validators(count->getValidatorList());
+        }
+        else if(auto filter= dynamic_cast<FilterNode*>(node))
+        {
+            validators(filter->getValidatorList());
+        }
+        else if(auto occurence= dynamic_cast<OccurenceCountNode*>(node))
+        {
+            validators(occurence->getValidatorList());
+        }
+    }
+
+    void validators(const ValidatorList* list)
+    {
+        // operands of conditions are run while dice are checked: c[>$1] reads instruction 1.
+        if(nullptr == list)
+            return;
+        for(auto validator : list->getValidators())
+        {
+            if(auto boolean= dynamic_cast<BooleanCondition*>(validator))
+            {
+                chain(boolean->getValueNode());
+            }
+            else if(auto operation= dynamic_cast<OperationCondition*>(validator))
+            {
+                chain(operation->getValueNode());
+                if(nullptr != operation->getBoolean())
+                    chain(operation->getBoolean()->getValueNode());
+            }
+        }
+    }
+
+    void engine(const std::shared_ptr<RandomEngine>& engine)
+    {
+        // a stream is only held by its node, the engine of the parser is also held by the parser and other nodes.
+        if(!engine || engine.use_count() > 1)
+            m_usage.sharedEngine= true;
+    }
+
+private:
+    Usage& m_usage;
+    std::unordered_set<ExecutionNode*> m_visited;
+};
+
+InstructionSchedule::InstructionSchedule() {}
+
+InstructionSchedule InstructionSchedule::analyse(const std::vector<ExecutionNode*>& instructions)
+{
+    auto count= instructions.size();
+    std::vector<Usage> usages(count);
+    bool entangled= false;
+    for(std::size_t i= 0; i < count; ++i)
+    {
+        auto& usage= usages[i];
+        Walker(usage).chain(instructions[i]);
+        // $n reading a later instruction gets what it holds when the reader runs.
+        auto forward= std::any_of(usage.variables.begin(), usage.variables.end(),
+                                  [i, count](std::size_t index) { return index >= i && index < count; });
+        entangled= entangled || usage.entangled || forward;
+    }
+
+    InstructionSchedule schedule;
+    schedule.m_dependencies.resize(count);
+    // $n marks the dice it reads as not displayed: readers of one instruction run in their order.
+    std::map<std::size_t, std::size_t> lastReader;
+    std::size_t lastShared= count;
+    for(std::size_t i= 0; i < count; ++i)
+    {
+        auto& dependencies= schedule.m_dependencies[i];
+        if(entangled)
+        {
+            if(i > 0)
+                dependencies.insert(i - 1);
+            continue;
+        }
+        for(auto index : usages[i].variables)
+        {
+            if(index >= count)
+                continue;
+            dependencies.insert(index);
+            auto reader= lastReader.find(index);
+            if(reader != lastReader.end())
+                dependencies.insert(reader->second);
+            lastReader[index]= i;
+        }
+        if(usages[i].sharedEngine)
+        {
+            if(lastShared < count)
+                dependencies.insert(lastShared);
+            lastShared= i;
+        }
+    }
+
+    std::vector<std::size_t> depth(count, 0);
+    for(std::size_t i= 0; i < count; ++i)
+    {
+        for(auto dependency : schedule.m_dependencies[i])
+            depth[i]= std::max(depth[i], depth[dependency] + 1);
+        if(depth[i] >= schedule.m_levels.size())
+            schedule.m_levels.resize(depth[i] + 1);
+        schedule.m_levels[depth[i]].push_back(i);
+    }
+    return schedule;
+}
+
+bool InstructionSchedule::readsResults(const std::vector<ExecutionNode*>& instructions)
+{
+    Usage usage;
+    Walker walker(usage);
+    for(auto instruction : instructions)
+        walker.chain(instruction);
+    return usage.entangled || !usage.variables.empty();
+}
+
+const std::set<std::size_t>& InstructionSchedule::dependencies(std::size_t instruction) const
+{
+    return m_dependencies[instruction];
+}
+
+const std::vector<std::vector<std::size_t>>& InstructionSchedule::levels() const
+{
+    return m_levels;
+}
+
+bool InstructionSchedule::isSequential() const
+{
+    return m_levels.size() == m_dependencies.size();
+}
+
+int InstructionSchedule::workerCount() const
+{
+    if(isSequential())
+        return 1;
+    std::size_t widest= 1;
+    for(auto const& level : m_levels)
+        widest= std::max(widest, level.size());
+    return std::max(1, std::min(QThreadPool::globalInstance()->maxThreadCount(), static_cast<int>(widest)));
+}
+
+void InstructionSchedule::run(const Task& task, int workers) const
+{
+    auto pool= QThreadPool::globalInstance();
+    for(auto const& instructions : m_levels)
+    {
+        if(ExecutionBudget::interrupted())
+            return;
+
+        Level level;
+        level.instructions= &instructions;
+        level.task= &task;
+        level.budget= ExecutionBudget::current();
+        level.next= 0;
+
+        QSemaphore finished;
+        auto wanted= std::min(workers, static_cast<int>(instructions.size())) - 1;
+        int helpers= 0;
+        while(helpers < wanted)
+        {
+            auto levelTask= new LevelTask(level, helpers + 1, finished);
+            if(!pool->tryStart(levelTask))
+            {
+                delete levelTask;
+                break;
+            }
+            ++helpers;
+        }
+        runLevel(level, 0);
+        finished.acquire(helpers);
+    }
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef INSTRUCTIONSCHEDULE_H
+#define INSTRUCTIONSCHEDULE_H
+
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <vector>
+
+class ExecutionNode;
+
+/**
+ * @brief The InstructionSchedule class sorts the instructions of a command (separated by ';') into levels. An
+ * instruction depends on the instructions it reads through $n, on the previous instruction reading one of them, and on
+ * the previous instruction drawing from the same engine. Merge and bind read and relink all the instructions, so a
+ * command holding one of them runs one instruction after the other. Instructions of one level depend on none of
+ * each other and may run at the same time: running the levels in order gives the results of the sequential run.
+ * Only the PHILOX engine gives each rolling node a stream of its own. Nodes of other engines, and nodes of prepared
+ * commands which hold no engine, share the engine of the parser: the instructions rolling dice then form one chain.
+ */
+class InstructionSchedule
+{
+public:
+    /**
+     * @brief Task runs one instruction. worker is the index of the thread running it, below the worker count given to
+     * run(), 0 being the calling thread.
+     */
+    using Task= std::function<void(std::size_t instruction, int worker)>;
+
+    InstructionSchedule();
+    static InstructionSchedule analyse(const std::vector<ExecutionNode*>& instructions);
+    /**
+     * @brief readsResults
+     * @return true if the instructions read or relink results of other instructions ($n, merge or bind), internal
+     * nodes and condition operands included.
+     */
+    static bool readsResults(const std::vector<ExecutionNode*>& instructions);
+
+    /**
+     * @brief dependencies
+     * @return instructions which must be over before the given one starts.
+     */
+    const std::set<std::size_t>& dependencies(std::size_t instruction) const;
+    const std::vector<std::vector<std::size_t>>& levels() const;
+    bool isSequential() const;
+    /**
+     * @brief workerCount
+     * @return number of threads worth running the schedule on, the calling one included.
+     */
+    int workerCount() const;
+    /**
+     * @brief run calls task for each instruction, level after level, on at most workers threads of the global pool.
+     * No instruction is started once the current execution budget is interrupted.
+     */
+    void run(const Task& task, int workers) const;
+
+private:
+    class Walker;
+
+private:
+    std::vector<std::set<std::size_t>> m_dependencies;
+    std::vector<std::vector<std::size_t>> m_levels;
+};
+
+#endif // INSTRUCTIONSCHEDULE_H
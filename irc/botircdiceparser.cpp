@@ -31,6 +31,7 @@ BotIrcDiceParser::BotIrcDiceParser(QObject* parent) : QObject(parent)
     m_socket= new QTcpSocket(this);
 
     m_parser= new DiceParser();
+    m_parser->setOutputCacheSize(256);
 
     // Connect signals and slots!
     connect(m_socket, SIGNAL(readyRead()), this, SLOT(readData()));
@@ -217,7 +218,11 @@ QString BotIrcDiceParser::diceToText(QList<ExportedDiceResult>& diceList, bool h
 
 QString BotIrcDiceParser::startDiceParsing(QString& cmd, bool highlight)
 {
-    QString result;
+    // commands without dice are answered from the cache, they are neither parsed nor run.
+    auto format= highlight ? QStringLiteral("irc-highlight") : QStringLiteral("irc");
+    QString result= m_parser->cachedOutput(cmd, format);
+    if(!result.isNull())
+        return result;
     QTextStream out(&result);
     if(m_parser->parseLine(cmd))
     {
@@ -272,5 +277,7 @@ QString BotIrcDiceParser::startDiceParsing(QString& cmd, bool highlight)
         ;
     }
 
+    out.flush();
+    m_parser->storeOutput(format, result);
     return result;
 }
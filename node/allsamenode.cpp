@@ -1,4 +1,6 @@
 #include "allsamenode.h"
+#include "executionbudget.h"
+#include "randomengine.h"
 
 AllSameNode::AllSameNode() : m_diceResult(new DiceResult())
 {
@@ -10,7 +12,7 @@ void AllSameNode::run(ExecutionNode* previous)
     m_previousNode= previous;
     if(nullptr != previous)
     {
-        DiceResult* previous_result= dynamic_cast<DiceResult*>(previous->getResult());
+        DiceResult* previous_result= Result::asDice(previous->getResult());
         if(nullptr != previous_result)
         {
             m_result->setPrevious(previous_result);
@@ -35,14 +37,14 @@ void AllSameNode::run(ExecutionNode* previous)
                 ++i;
             }
 
-            while(allSame)
+            while(allSame && !ExecutionBudget::interrupted())
             {
                 QList<Die*> list= m_diceResult->getResultList();
                 qint64 pValue= 0;
                 int i= 0;
                 for(auto& die : list)
                 {
-                    die->roll(true);
+                    die->roll(true, m_randomEngine.get());
                     if(i == 0)
                         pValue= die->getValue();
                     if(pValue != die->getValue())
@@ -62,11 +64,11 @@ QString AllSameNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"AllSameNode\"]").arg(m_id);
+        return QString("%1 [label=\"AllSameNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -82,5 +84,21 @@ qint64 AllSameNode::getPriority() const
 
 ExecutionNode* AllSameNode::getCopy() const
 {
-    return new AllSameNode();
+    AllSameNode* node= new AllSameNode();
+    node->setRandomEngine(m_randomEngine);
+    if(nullptr != m_nextNode)
+    {
+        node->setNextNode(m_nextNode->getCopy());
+    }
+    return node;
+}
+
+void AllSameNode::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+const std::shared_ptr<RandomEngine>& AllSameNode::getRandomEngine() const
+{
+    return m_randomEngine;
 }
@@ -1,11 +1,15 @@
 #ifndef ALLSAMENODE_H
 #define ALLSAMENODE_H
 
+#include <memory>
+
 #include "executionnode.h"
 
 #include "result/diceresult.h"
 #include "validator.h"
 
+class RandomEngine;
+
 class AllSameNode : public ExecutionNode
 {
 public:
@@ -26,8 +30,12 @@ public:
 
     virtual ExecutionNode* getCopy() const;
 
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    const std::shared_ptr<RandomEngine>& getRandomEngine() const;
+
 private:
     DiceResult* m_diceResult;
+    std::shared_ptr<RandomEngine> m_randomEngine;
 };
 
 #endif // FILTERNODE_H
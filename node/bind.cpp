@@ -40,7 +40,7 @@ void BindNode::run(ExecutionNode* previous)
             auto tmpResult= last->getResult();
             while(nullptr != tmpResult)
             {
-                DiceResult* dice= dynamic_cast<DiceResult*>(tmpResult);
+                DiceResult* dice= Result::asDice(tmpResult);
                 if(nullptr != dice)
                 {
                     m_diceResult->setHomogeneous(false);
@@ -77,11 +77,11 @@ QString BindNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"Bind Node\"]").arg(m_id);
+        return QString("%1 [label=\"Bind Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 BindNode::getPriority() const
@@ -96,6 +96,7 @@ qint64 BindNode::getPriority() const
 ExecutionNode* BindNode::getCopy() const
 {
     BindNode* node= new BindNode();
+    node->setStartList(copyStartList(m_startList));
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -1,6 +1,7 @@
 #include "countexecutenode.h"
 #include "result/diceresult.h"
 #include "validatorlist.h"
+#include <unordered_map>
 
 CountExecuteNode::CountExecuteNode() : m_scalarResult(new ScalarResult()), m_validatorList(nullptr)
 {
@@ -10,6 +11,10 @@ void CountExecuteNode::setValidatorList(ValidatorList* validatorlist)
 {
     m_validatorList= validatorlist;
 }
+ValidatorList* CountExecuteNode::getValidatorList() const
+{
+    return m_validatorList;
+}
 CountExecuteNode::~CountExecuteNode()
 {
     if(nullptr != m_validatorList)
@@ -25,13 +30,21 @@ void CountExecuteNode::run(ExecutionNode* previous)
     {
         return;
     }
-    DiceResult* previousResult= dynamic_cast<DiceResult*>(previous->getResult());
+    DiceResult* previousResult= Result::asDice(previous->getResult());
     if(nullptr != previousResult)
     {
         m_result->setPrevious(previousResult);
         qint64 sum= 0;
-        std::function<void(Die*, qint64)> f= [&sum](const Die*, qint64 score) { sum+= score; };
-        m_validatorList->validResult(previousResult, true, true, f);
+        auto histogram= previousResult->histogram();
+        if(nullptr != histogram && m_validatorList->dependsOnRollsOnly())
+        {
+            sum= countHistogram(histogram);
+        }
+        else
+        {
+            std::function<void(Die*, qint64)> f= [&sum](const Die*, qint64 score) { sum+= score; };
+            m_validatorList->validResult(previousResult, true, true, f);
+        }
         m_scalarResult->setValue(sum);
         if(nullptr != m_nextNode)
         {
@@ -39,15 +52,48 @@ void CountExecuteNode::run(ExecutionNode* previous)
         }
     }
 }
+qint64 CountExecuteNode::countHistogram(DiceHistogram* histogram) const
+{
+    DiceResult faces;
+    std::unordered_map<const Die*, std::size_t> buckets;
+    for(std::size_t b= 0; b < histogram->bucketCount(); ++b)
+    {
+        auto const& bucket= histogram->bucket(b);
+        Die* die= new Die();
+        die->setOp(histogram->op());
+        die->setBase(histogram->base());
+        die->setMaxValue(histogram->maxValue());
+        die->insertRollValue(bucket.value);
+        die->setHighlighted(bucket.highlighted == bucket.count);
+        faces.insertResult(die);
+        buckets[die]= b;
+    }
+
+    qint64 sum= 0;
+    std::function<void(Die*, qint64)> f= [histogram, &buckets, &sum](const Die* die, qint64 score) {
+        sum+= score * static_cast<qint64>(histogram->bucket(buckets[die]).count);
+    };
+    m_validatorList->validResult(&faces, true, true, f);
+
+    // the checks light or unlight the whole bucket.
+    for(auto die : faces.getResultList())
+    {
+        auto b= buckets[die];
+        auto const& bucket= histogram->bucket(b);
+        if(die->isHighlighted() != (bucket.highlighted == bucket.count))
+            histogram->setFlagOnBucket(b, CompactDiceList::Highlighted, die->isHighlighted());
+    }
+    return sum;
+}
 QString CountExecuteNode::toString(bool withlabel) const
 {
     if(withlabel)
     {
-        return QString("%1 [label=\"CountExecuteNode %2\"]").arg(m_id, m_validatorList->toString());
+        return QString("%1 [label=\"CountExecuteNode %2\"]").arg(dotId(), m_validatorList->toString());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 CountExecuteNode::getPriority() const
@@ -5,6 +5,7 @@
 
 #include "result/scalarresult.h"
 
+class DiceHistogram;
 class ValidatorList;
 /**
  * @brief The CountExecuteNode class
@@ -26,6 +27,7 @@ public:
      * @brief setValidator
      */
     virtual void setValidatorList(ValidatorList*);
+    ValidatorList* getValidatorList() const;
     /**
      * @brief toString
      * @return
@@ -42,6 +44,12 @@ public:
      */
     virtual ExecutionNode* getCopy() const;
 
+private:
+    /**
+     * @brief countHistogram checks one die per face value and weights its score by the size of the bucket.
+     */
+    qint64 countHistogram(DiceHistogram* histogram) const;
+
 private:
     ScalarResult* m_scalarResult;
     ValidatorList* m_validatorList;
@@ -1,13 +1,26 @@
 #include "dicerollernode.h"
 #include "die.h"
+#include "executionbudget.h"
+#include "node/countexecutenode.h"
+#include "node/keepdiceexecnode.h"
+#include "node/occurencecountnode.h"
+#include "node/scalaroperatornode.h"
+#include "node/sortresult.h"
+#include "randomengine.h"
+#include "validatorlist.h"
 
 #include <QDebug>
 #include <QThread>
 #include <QThreadPool>
 #include <QTime>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+const quint64 DiceRollerNode::maxPoolSize;
 
 DiceRollerNode::DiceRollerNode(qint64 max, qint64 min)
-    : m_max(max), m_diceResult(new DiceResult()), m_min(min), m_operator(Die::PLUS)
+    : m_diceCount(0), m_max(max), m_diceResult(new DiceResult()), m_min(min), m_operator(Die::PLUS), m_unique(false)
 {
     m_result= m_diceResult;
 }
@@ -24,7 +37,8 @@ void DiceRollerNode::run(ExecutionNode* previous)
             {
                 m_errors.insert(Dice::ERROR_CODE::NO_DICE_TO_ROLL, QObject::tr("No dice to roll"));
             }
-            m_diceCount= num > 0 ? static_cast<quint64>(num) : 0;
+            // clamped so that a count out of the quint64 range is refused as too large.
+            m_diceCount= num > 0 ? static_cast<quint64>(std::min<qreal>(num, maxPoolSize + 1)) : 0;
             m_result->setPrevious(result);
 
             auto possibleValue= static_cast<quint64>(std::abs((m_max - m_min) + 1));
@@ -34,23 +48,67 @@ void DiceRollerNode::run(ExecutionNode* previous)
                                 QObject::tr("More unique values asked than possible values (D operator)"));
                 return;
             }
+            // checked before the pool gets any memory: the count comes straight from the command.
+            if(m_diceCount > maxPoolSize)
+            {
+                m_errors.insert(Dice::ERROR_CODE::TOO_MANY_DICE,
+                                QObject::tr("Too many dice: a roll can not have more than %1 dice").arg(maxPoolSize));
+                return;
+            }
+            if(!ExecutionBudget::allowDice(m_diceCount)
+               || (m_max != 0 && !ExecutionBudget::allowRolls(m_diceCount)))
+                return;
 
-            for(quint64 i= 0; i < m_diceCount; ++i)
+            RandomEngine* engine= RandomEngine::select(m_randomEngine.get());
+            if(m_unique && m_diceCount > 0)
             {
-                Die* die= new Die();
-                die->setOp(m_operator);
-                die->setBase(m_min);
-                die->setMaxValue(m_max);
-                die->roll();
-                if(m_unique)
+                // partial Fisher-Yates over the virtual array [m_min, m_max], only moved slots are stored.
+                std::vector<qint64> values(m_diceCount);
+                std::unordered_map<quint64, quint64> moved;
+                auto slot= [&moved](quint64 i) {
+                    auto it= moved.find(i);
+                    return it == moved.end() ? i : it->second;
+                };
+                const auto last= static_cast<qint64>(possibleValue - 1);
+                for(quint64 i= 0; i < m_diceCount; ++i)
                 {
-                    const auto& equal= [](const Die* a, const Die* b) { return a->getValue() == b->getValue(); };
-                    while(m_diceResult->contains(die, equal))
-                    {
-                        die->roll(false);
-                    }
+                    auto j= static_cast<quint64>(engine->bounded(static_cast<qint64>(i), last));
+                    auto picked= slot(j);
+                    moved[j]= slot(i);
+                    values[i]= m_min + static_cast<qint64>(picked);
+                }
+                m_diceResult->setCompactResult(m_min, m_max, m_operator, values.data(), values.size());
+            }
+            else if(usesHistogram(m_diceCount))
+            {
+                // only the number of dice showing each face is drawn.
+                std::vector<qint64> counts(static_cast<std::size_t>(getFaces()));
+                engine->fillMultinomial(static_cast<qint64>(m_diceCount), counts.data(), counts.size());
+                DiceHistogram histogram;
+                histogram.assign(std::min(m_min, m_max), std::max(m_min, m_max), m_operator, counts.data(),
+                                 counts.size());
+                // shown die by die, the pool reads in a random order as rolled dice would, not grouped by face.
+                histogram.setRollOrder(engine->next());
+                m_diceResult->setHistogram(histogram);
+            }
+            else if(m_max != 0)
+            {
+                // the whole pool is drawn in one pass and kept compact, Die objects are only built if a later
+                // node asks for them.
+                std::vector<qint64> values(m_diceCount);
+                engine->fillBounded(m_min, m_max, values.data(), values.size());
+                m_diceResult->setCompactResult(m_min, m_max, m_operator, values.data(), values.size());
+            }
+            else
+            {
+                for(quint64 i= 0; i < m_diceCount; ++i)
+                {
+                    Die* die= new Die();
+                    die->setOp(m_operator);
+                    die->setBase(m_min);
+                    die->setMaxValue(m_max);
+                    m_diceResult->insertResult(die);
                 }
-                m_diceResult->insertResult(die);
             }
             if(nullptr != m_nextNode)
             {
@@ -60,6 +118,42 @@ void DiceRollerNode::run(ExecutionNode* previous)
     }
 }
 
+bool DiceRollerNode::usesHistogram(quint64 count) const
+{
+    if(m_unique || m_max == 0 || m_operator != Die::PLUS || count < histogramThreshold || getFaces() > count / 4)
+        return false;
+
+    // the dice of a histogram have no roll order: the chain has to end in a node which ignores it. Dice left as
+    // they are, or only sorted, are shown and read by $n in roll order.
+    bool sorted= false;
+    bool kept= false;
+    for(ExecutionNode* node= m_nextNode; nullptr != node; node= node->getNextNode())
+    {
+        if(nullptr != dynamic_cast<SortResultNode*>(node))
+        {
+            sorted= true;
+        }
+        else if(nullptr != dynamic_cast<KeepDiceExecNode*>(node))
+        {
+            if(!sorted)
+                return false;
+            kept= true;
+        }
+        else if(auto counter= dynamic_cast<CountExecuteNode*>(node))
+        {
+            auto validators= counter->getValidatorList();
+            return nullptr != validators && validators->dependsOnRollsOnly();
+        }
+        else
+        {
+            // the next nodes read a sum or occurrences, not dice.
+            return nullptr != dynamic_cast<ScalarOperatorNode*>(node)
+                   || nullptr != dynamic_cast<OccurenceCountNode*>(node);
+        }
+    }
+    return kept;
+}
+
 quint64 DiceRollerNode::getFaces() const
 {
     return static_cast<quint64>(std::abs(m_max - m_min) + 1);
@@ -73,11 +167,11 @@ QString DiceRollerNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"DiceRollerNode faces: %2\"]").arg(m_id).arg(getFaces());
+        return QString("%1 [label=\"DiceRollerNode faces: %2\"]").arg(dotId()).arg(getFaces());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 DiceRollerNode::getPriority() const
@@ -92,6 +186,9 @@ qint64 DiceRollerNode::getPriority() const
 ExecutionNode* DiceRollerNode::getCopy() const
 {
     DiceRollerNode* node= new DiceRollerNode(m_max, m_min);
+    node->setOperator(m_operator);
+    node->setUnique(m_unique);
+    node->setRandomEngine(m_randomEngine);
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -119,3 +216,13 @@ void DiceRollerNode::setUnique(bool unique)
 {
     m_unique= unique;
 }
+
+void DiceRollerNode::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+const std::shared_ptr<RandomEngine>& DiceRollerNode::getRandomEngine() const
+{
+    return m_randomEngine;
+}
@@ -5,7 +5,10 @@
 
 #include "executionnode.h"
 #include "result/diceresult.h"
+#include <memory>
 #include <utility>
+
+class RandomEngine;
 /**
  * @brief The DiceRollerNode class rolls dice of one kind.
  */
@@ -51,6 +54,26 @@ public:
     bool getUnique() const;
     void setUnique(bool unique);
 
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    const std::shared_ptr<RandomEngine>& getRandomEngine() const;
+
+    /**
+     * @brief usesHistogram
+     * @return true if count dice are rolled as a DiceHistogram: a large pool of plain rolls, much larger than the
+     * number of faces, whose chain ends in a count, an occurrence check, an arithmetic operator or a keep after a sort.
+     */
+    bool usesHistogram(quint64 count) const;
+
+    /**
+     * @brief histogramThreshold smallest pool rolled as a histogram.
+     */
+    static const quint64 histogramThreshold= 1024;
+    /**
+     * @brief maxPoolSize largest pool a single roll can make, larger ones fail with TOO_MANY_DICE whatever the
+     * execution budget.
+     */
+    static const quint64 maxPoolSize= 1000000;
+
 private:
     quint64 m_diceCount;
     qint64 m_max; /// faces
@@ -58,6 +81,7 @@ private:
     qint64 m_min;
     Die::ArithmeticOperator m_operator;
     bool m_unique;
+    std::shared_ptr<RandomEngine> m_randomEngine;
 };
 
 #endif // DICEROLLERNODE_H
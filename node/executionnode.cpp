@@ -1,13 +1,25 @@
 #include "executionnode.h"
 
-#include <QUuid>
+#include <atomic>
+
+namespace
+{
+std::atomic<quint64> s_lastNodeId(0);
+
+struct StartListRedirection
+{
+    const std::vector<ExecutionNode*>* from= nullptr;
+    std::vector<ExecutionNode*>* to= nullptr;
+};
+thread_local StartListRedirection redirection;
+} // namespace
 
 ExecutionNode::ExecutionNode()
     : m_previousNode(nullptr)
     , m_result(nullptr)
     , m_nextNode(nullptr)
     , m_errors(QMap<Dice::ERROR_CODE, QString>())
-    , m_id(QString("\"%1\"").arg(QUuid::createUuid().toString()))
+    , m_id(s_lastNodeId.fetch_add(1, std::memory_order_relaxed) + 1)
 {
 }
 ExecutionNode::~ExecutionNode()
@@ -52,10 +64,38 @@ QMap<Dice::ERROR_CODE, QString> ExecutionNode::getExecutionErrorMap()
     }
     return m_errors;
 }
+QString ExecutionNode::dotId() const
+{
+    return QStringLiteral("\"n%1\"").arg(m_id);
+}
+
+bool ExecutionNode::reset()
+{
+    m_errors.clear();
+    if(nullptr != m_result)
+        m_result->reset();
+    return resetNext();
+}
+bool ExecutionNode::resetNext()
+{
+    return nullptr == m_nextNode || m_nextNode->reset();
+}
+
 QString ExecutionNode::getHelp()
 {
     return QString();
 }
+void ExecutionNode::redirectStartList(const std::vector<ExecutionNode*>* from, std::vector<ExecutionNode*>* to)
+{
+    redirection.from= from;
+    redirection.to= to;
+}
+std::vector<ExecutionNode*>* ExecutionNode::copyStartList(std::vector<ExecutionNode*>* list)
+{
+    if(nullptr != redirection.from && list == redirection.from)
+        return redirection.to;
+    return list;
+}
 ExecutionNode* ExecutionNode::getPreviousNode() const
 {
     return m_previousNode;
@@ -1,13 +1,16 @@
 #ifndef EXECUTIONNODE_H
 #define EXECUTIONNODE_H
 
+#include <vector>
+
+#include "dicearena.h"
 #include "diceparserhelper.h"
 #include "result/result.h"
 
 /**
  * @brief The ExecutionNode class
  */
-class ExecutionNode
+class ExecutionNode : public ArenaObject
 {
 public:
     /**
@@ -75,9 +78,36 @@ public:
      * @return should return a copy of that node.
      */
     virtual ExecutionNode* getCopy() const= 0;
+    /**
+     * @brief reset clears what the last run left in this node and in the following ones, so they can run again.
+     * @return false if the last run has changed the tree, which then has to be copied instead.
+     */
+    virtual bool reset();
 
     virtual qint64 getScalarResult();
 
+    /**
+     * @brief redirectStartList makes the nodes copied afterwards by the calling thread ($n, m and b) refer to another
+     * instruction list. Give nullptr as from to stop.
+     */
+    static void redirectStartList(const std::vector<ExecutionNode*>* from, std::vector<ExecutionNode*>* to);
+    /**
+     * @brief copyStartList
+     * @return instruction list a copied node has to refer to in place of list.
+     */
+    static std::vector<ExecutionNode*>* copyStartList(std::vector<ExecutionNode*>* list);
+
+protected:
+    /**
+     * @brief dotId
+     * @return id of the node as a DOT node name.
+     */
+    QString dotId() const;
+    /**
+     * @brief resetNext resets the following nodes only.
+     */
+    bool resetNext();
+
 protected:
     /**
      * @brief m_nextNode
@@ -95,8 +125,10 @@ protected:
      * @brief m_errors
      */
     QMap<Dice::ERROR_CODE, QString> m_errors;
-
-    QString m_id;
+    /**
+     * @brief m_id number of the node, turned into text only by dotId().
+     */
+    quint64 m_id;
 };
 
 #endif // EXECUTIONNODE_H
@@ -1,4 +1,6 @@
 #include "explodedicenode.h"
+#include "executionbudget.h"
+#include "randomengine.h"
 #include "validatorlist.h"
 
 ExplodeDiceNode::ExplodeDiceNode() : m_diceResult(new DiceResult())
@@ -10,7 +12,7 @@ void ExplodeDiceNode::run(ExecutionNode* previous)
     m_previousNode= previous;
     if((nullptr != previous) && (nullptr != previous->getResult()))
     {
-        DiceResult* previous_result= dynamic_cast<DiceResult*>(previous->getResult());
+        DiceResult* previous_result= Result::asDice(previous->getResult());
         m_result->setPrevious(previous_result);
         if(nullptr != previous_result)
         {
@@ -37,15 +39,16 @@ void ExplodeDiceNode::run(ExecutionNode* previous)
                                         .arg(QStringLiteral("d[%1,%2]")
                                                  .arg(static_cast<int>(die->getBase()))
                                                  .arg(static_cast<int>(die->getMaxValue()))));
+                    return;
                 }
                 hasExploded= true;
-                die->roll(true);
+                die->roll(true, m_randomEngine.get());
             };
             do
             {
                 hasExploded= false;
                 m_validatorList->validResult(m_diceResult, false, false, f);
-            } while(hasExploded);
+            } while(hasExploded && !ExecutionBudget::interrupted());
 
             /*for(auto& die : list)
             {
@@ -59,7 +62,7 @@ void ExplodeDiceNode::run(ExecutionNode* previous)
 
                 while(m_validatorList->hasValid(die, false))
                 {
-                    die->roll(true);
+                    die->roll(true, m_randomEngine.get());
                 }
             }*/
 
@@ -81,15 +84,19 @@ void ExplodeDiceNode::setValidatorList(ValidatorList* val)
 {
     m_validatorList= val;
 }
+ValidatorList* ExplodeDiceNode::getValidatorList() const
+{
+    return m_validatorList;
+}
 QString ExplodeDiceNode::toString(bool withlabel) const
 {
     if(withlabel)
     {
-        return QString("%1 [label=\"ExplodeDiceNode %2\"]").arg(m_id, m_validatorList->toString());
+        return QString("%1 [label=\"ExplodeDiceNode %2\"]").arg(dotId(), m_validatorList->toString());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ExplodeDiceNode::getPriority() const
@@ -105,6 +112,7 @@ qint64 ExplodeDiceNode::getPriority() const
 ExecutionNode* ExplodeDiceNode::getCopy() const
 {
     ExplodeDiceNode* node= new ExplodeDiceNode();
+    node->setRandomEngine(m_randomEngine);
     if(nullptr != m_validatorList)
     {
         node->setValidatorList(m_validatorList->getCopy());
@@ -115,3 +123,13 @@ ExecutionNode* ExplodeDiceNode::getCopy() const
     }
     return node;
 }
+
+void ExplodeDiceNode::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+const std::shared_ptr<RandomEngine>& ExplodeDiceNode::getRandomEngine() const
+{
+    return m_randomEngine;
+}
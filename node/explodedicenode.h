@@ -1,10 +1,13 @@
 #ifndef EXPLOSEDICENODE_H
 #define EXPLOSEDICENODE_H
 
+#include <memory>
+
 #include "executionnode.h"
 #include "result/diceresult.h"
 
 class ValidatorList;
+class RandomEngine;
 
 /**
  * @brief The ExplodeDiceNode class explode dice while is valid by the validator.
@@ -16,14 +19,19 @@ public:
     virtual ~ExplodeDiceNode();
     virtual void run(ExecutionNode* previous= nullptr);
     virtual void setValidatorList(ValidatorList*);
+    ValidatorList* getValidatorList() const;
     virtual QString toString(bool) const;
     virtual qint64 getPriority() const;
 
     virtual ExecutionNode* getCopy() const;
 
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    const std::shared_ptr<RandomEngine>& getRandomEngine() const;
+
 protected:
     DiceResult* m_diceResult;
     ValidatorList* m_validatorList= nullptr;
+    std::shared_ptr<RandomEngine> m_randomEngine;
 };
 
 #endif // EXPLOSEDICENODE_H
@@ -17,6 +17,10 @@ void FilterNode::setValidatorList(ValidatorList* validatorlist)
 {
     m_validatorList= validatorlist;
 }
+ValidatorList* FilterNode::getValidatorList() const
+{
+    return m_validatorList;
+}
 void FilterNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
@@ -24,7 +28,7 @@ void FilterNode::run(ExecutionNode* previous)
     {
         return;
     }
-    DiceResult* previousDiceResult= dynamic_cast<DiceResult*>(previous->getResult());
+    DiceResult* previousDiceResult= Result::asDice(previous->getResult());
     m_result->setPrevious(previousDiceResult);
 
     if(nullptr != previousDiceResult)
@@ -62,11 +66,11 @@ QString FilterNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"FilterNode\"]").arg(m_id);
+        return QString("%1 [label=\"FilterNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 FilterNode::getPriority() const
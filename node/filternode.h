@@ -18,6 +18,7 @@ public:
      * @brief setValidator
      */
     virtual void setValidatorList(ValidatorList*);
+    ValidatorList* getValidatorList() const;
     /**
      * @brief toString
      * @return
@@ -39,7 +39,7 @@ void ForLoopNode::run(ExecutionNode* previous)
 {
     if(nullptr != previous)
     {
-        auto prevResult= dynamic_cast<DiceResult*>(previous->getResult());
+        auto prevResult= Result::asDice(previous->getResult());
         if(nullptr != prevResult)
         {
             m_diceResult->setPrevious(prevResult);
@@ -84,11 +84,11 @@ QString ForLoopNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"ForLoopNode Node\"]").arg(m_id);
+        return QString("%1 [label=\"ForLoopNode Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -99,5 +99,9 @@ ExecutionNode* ForLoopNode::getCopy() const
     {
         node->setInternal(m_internal->getCopy());
     }
+    if(nullptr != m_nextNode)
+    {
+        node->setNextNode(m_nextNode->getCopy());
+    }
     return node;
 }
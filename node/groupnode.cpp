@@ -20,6 +20,7 @@
  * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
  ***************************************************************************/
 #include "groupnode.h"
+#include "executionbudget.h"
 #include "result/diceresult.h"
 //-------------------------------
 int DieGroup::getSum() const
@@ -57,7 +58,7 @@ void DieGroup::setExceptedValue(qint64 exceptedValue)
 
 //---------------------
 GroupNode::GroupNode(bool complexOutput)
-    : m_scalarResult(new ScalarResult), m_stringResult(new StringResult), m_complexOutput(complexOutput)
+    : m_scalarResult(new ScalarResult), m_stringResult(new StringResult), m_groupValue(0), m_complexOutput(complexOutput)
 {
 }
 
@@ -75,14 +76,13 @@ void GroupNode::run(ExecutionNode* previous)
         Result* tmpResult= previous->getResult();
         if(nullptr != tmpResult)
         {
-            DiceResult* dice= dynamic_cast<DiceResult*>(tmpResult);
+            DiceResult* dice= Result::asDice(tmpResult);
             if(nullptr != dice)
             {
-                auto list= dice->getResultList();
                 DieGroup allResult;
-                for(auto& die : list)
+                for(const auto& die : dice->view())
                 {
-                    allResult << die->getListValue();
+                    allResult << die.getListValue();
                 }
                 std::sort(allResult.begin(), allResult.end(), std::greater<qint64>());
                 if(allResult.getSum() > m_groupValue)
@@ -132,11 +132,11 @@ QString GroupNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"SplitNode Node\"]").arg(m_id);
+        return QString("%1 [label=\"SplitNode Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 GroupNode::getPriority() const
@@ -151,6 +151,7 @@ qint64 GroupNode::getPriority() const
 ExecutionNode* GroupNode::getCopy() const
 {
     GroupNode* node= new GroupNode(m_complexOutput);
+    node->setGroupValue(m_groupValue);
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -192,7 +193,7 @@ bool GroupNode::composeWithPrevious(DieGroup previous, qint64 first, qint64 curr
         possibleUnion.append(dieG);
     }
 
-    while(!hasReachMax)
+    while(!hasReachMax && !ExecutionBudget::interrupted())
     {
         auto tmpValues= previous;
         QList<DieGroup> possibleTmp;
@@ -257,7 +258,7 @@ QList<DieGroup> GroupNode::getGroup(DieGroup values)
         bool foundPerfect= false;
         qint64 cumuledValue= 0;
         DieGroup previousValue;
-        while((values.rend() != it) && !foundPerfect)
+        while((values.rend() != it) && !foundPerfect && !ExecutionBudget::interrupted())
         {
             if(first + *it == m_groupValue)
             {
@@ -26,7 +26,7 @@ HelpNode::HelpNode() : m_path("https://github.com/Rolisteam/DiceParser/blob/mast
 void HelpNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
-    StringResult* txtResult= dynamic_cast<StringResult*>(m_result);
+    StringResult* txtResult= Result::asString(m_result);
     txtResult->setHighLight(false);
 
     if((nullptr == previous) && (txtResult != nullptr))
@@ -114,11 +114,11 @@ QString HelpNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"Rolisteam Dice Parser:\nFull documentation at: %2\"]").arg(m_id, m_path);
+        return QString("%1 [label=\"Rolisteam Dice Parser:\nFull documentation at: %2\"]").arg(dotId(), m_path);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -134,6 +134,7 @@ void HelpNode::setHelpPath(QString path)
 ExecutionNode* HelpNode::getCopy() const
 {
     HelpNode* node= new HelpNode();
+    node->setHelpPath(m_path);
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -58,11 +58,11 @@ QString PartialDiceRollNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"PartialDiceRollNode \"]").arg(m_id);
+        return QString("%1 [label=\"PartialDiceRollNode \"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -74,7 +74,7 @@ DiceResult* getFirstDiceResult(Result* result)
         return found;
     do
     {
-        found= dynamic_cast<DiceResult*>(result);
+        found= Result::asDice(result);
         result= result->getPrevious();
     } while((nullptr == found) && (result != nullptr));
 
@@ -245,6 +245,18 @@ void IfNode::setInstructionFalse(ExecutionNode* node)
 {
     m_false= node;
 }
+ValidatorList* IfNode::getValidatorList() const
+{
+    return m_validatorList;
+}
+ExecutionNode* IfNode::getInstructionTrue() const
+{
+    return m_true;
+}
+ExecutionNode* IfNode::getInstructionFalse() const
+{
+    return m_false;
+}
 void IfNode::generateDotTree(QString& s)
 {
     s.append(toString(true));
@@ -297,11 +309,11 @@ QString IfNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"IfNode\"]").arg(m_id);
+        return QString("%1 [label=\"IfNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -352,3 +364,9 @@ ExecutionNode* IfNode::getCopy() const
     }
     return node;
 }
+
+bool IfNode::reset()
+{
+    // the branches are copied and linked into the tree while running.
+    return false;
+}
@@ -63,6 +63,7 @@ public:
      * @brief setValidator
      */
     virtual void setValidatorList(ValidatorList*);
+    ValidatorList* getValidatorList() const;
     /**
      * @brief setInstructionTrue
      */
@@ -71,6 +72,8 @@ public:
      * @brief setInstructionFalse
      */
     virtual void setInstructionFalse(ExecutionNode*);
+    ExecutionNode* getInstructionTrue() const;
+    ExecutionNode* getInstructionFalse() const;
     /**
      * @brief toString
      * @return
@@ -92,6 +95,7 @@ public:
      * @return
      */
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
     /**
      * @brief getConditionType
      * @return
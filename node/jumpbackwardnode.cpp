@@ -37,11 +37,11 @@ QString JumpBackwardNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"JumpBackwardNode\"]").arg(m_id);
+        return QString("%1 [label=\"JumpBackwardNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 void JumpBackwardNode::generateDotTree(QString& s)
@@ -124,7 +124,7 @@ void JumpBackwardNode::run(ExecutionNode* previous)
     }
     else
     {
-        DiceResult* diceResult= dynamic_cast<DiceResult*>(result);
+        DiceResult* diceResult= Result::asDice(result);
         if(nullptr != diceResult)
         {
             for(auto& die : diceResult->getResultList())
@@ -34,18 +34,23 @@ void KeepDiceExecNode::run(ExecutionNode* previous)
     {
         return;
     }
-    DiceResult* previousDiceResult= dynamic_cast<DiceResult*>(previous->getResult());
+    DiceResult* previousDiceResult= Result::asDice(previous->getResult());
     m_result->setPrevious(previousDiceResult);
-    if(nullptr != previousDiceResult)
+    if(nullptr != previousDiceResult && nullptr != previousDiceResult->histogram())
+    {
+        runOnHistogram(previousDiceResult->histogram());
+    }
+    else if(nullptr != previousDiceResult)
     {
         QList<Die*> diceList= previousDiceResult->getResultList();
 
-        if(m_numberOfDice < 0)
+        auto numberOfDice= m_numberOfDice;
+        if(numberOfDice < 0)
         {
-            m_numberOfDice= diceList.size() + m_numberOfDice;
+            numberOfDice= diceList.size() + numberOfDice;
         }
 
-        QList<Die*> diceList3= diceList.mid(0, static_cast<int>(m_numberOfDice));
+        QList<Die*> diceList3= diceList.mid(0, static_cast<int>(numberOfDice));
         QList<Die*> diceList2;
 
         for(Die* die : diceList3)
@@ -56,15 +61,15 @@ void KeepDiceExecNode::run(ExecutionNode* previous)
             die->displayed();
         }
 
-        if(m_numberOfDice > static_cast<qint64>(diceList.size()))
+        if(numberOfDice > static_cast<qint64>(diceList.size()))
         {
             m_errors.insert(Dice::ERROR_CODE::TOO_MANY_DICE,
                             QObject::tr(" You ask to keep %1 dice but the result only has %2")
-                                .arg(m_numberOfDice)
+                                .arg(numberOfDice)
                                 .arg(diceList.size()));
         }
 
-        for(auto& tmp : diceList.mid(static_cast<int>(m_numberOfDice), -1))
+        for(auto& tmp : diceList.mid(static_cast<int>(numberOfDice), -1))
         {
             tmp->setHighlighted(false);
         }
@@ -76,19 +81,45 @@ void KeepDiceExecNode::run(ExecutionNode* previous)
         }
     }
 }
+void KeepDiceExecNode::runOnHistogram(DiceHistogram* histogram)
+{
+    auto size= static_cast<qint64>(histogram->size());
+    auto numberOfDice= m_numberOfDice;
+    if(numberOfDice < 0)
+    {
+        numberOfDice= size + numberOfDice;
+    }
+    if(numberOfDice > size)
+    {
+        m_errors.insert(Dice::ERROR_CODE::TOO_MANY_DICE,
+                        QObject::tr(" You ask to keep %1 dice but the result only has %2").arg(numberOfDice).arg(size));
+    }
+
+    auto kept= static_cast<std::size_t>(numberOfDice < 0 ? size : std::min(numberOfDice, size));
+    m_diceResult->setHistogram(histogram->first(kept));
+    histogram->keepFirst(kept);
+    if(nullptr != m_nextNode)
+    {
+        m_nextNode->run(this);
+    }
+}
 void KeepDiceExecNode::setDiceKeepNumber(qint64 n)
 {
     m_numberOfDice= n;
 }
+qint64 KeepDiceExecNode::getDiceKeepNumber() const
+{
+    return m_numberOfDice;
+}
 QString KeepDiceExecNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"KeepDiceExecNode %2\"]").arg(m_id).arg(m_numberOfDice);
+        return QString("%1 [label=\"KeepDiceExecNode %2\"]").arg(dotId()).arg(m_numberOfDice);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 KeepDiceExecNode::getPriority() const
@@ -35,10 +35,17 @@ public:
 
     virtual void run(ExecutionNode* previous);
     virtual void setDiceKeepNumber(qint64);
+    qint64 getDiceKeepNumber() const;
     virtual QString toString(bool) const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode* getCopy() const;
 
+private:
+    /**
+     * @brief runOnHistogram keeps the first dice of a histogram without building them.
+     */
+    void runOnHistogram(DiceHistogram* histogram);
+
 private:
     qint64 m_numberOfDice= 0;
     DiceResult* m_diceResult;
@@ -27,7 +27,7 @@ ListAliasNode::ListAliasNode(const QList<DiceAlias*>& apAlias) : m_aliasList(apA
 void ListAliasNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
-    StringResult* txtResult= dynamic_cast<StringResult*>(m_result);
+    StringResult* txtResult= Result::asString(m_result);
     txtResult->setHighLight(false);
 
     txtResult->addText(buildList());
@@ -62,11 +62,11 @@ QString ListAliasNode::toString(bool wl) const
 
     if(wl)
     {
-        return QString("%1 [label=\"ListAliasNode %2\"]").arg(m_id, resultList.join(","));
+        return QString("%1 [label=\"ListAliasNode %2\"]").arg(dotId(), resultList.join(","));
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ListAliasNode::getPriority() const
@@ -20,8 +20,10 @@
  *************************************************************************/
 #include "listsetrollnode.h"
 #include "die.h"
+#include "randomengine.h"
 
 #include <QDebug>
+#include <algorithm>
 
 ListSetRollNode::ListSetRollNode() : m_diceResult(new DiceResult()), m_stringResult(new StringResult()), m_unique(false)
 {
@@ -44,11 +46,11 @@ QString ListSetRollNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"ListSetRoll list:%2\"]").arg(m_id, m_values.join(","));
+        return QString("%1 [label=\"ListSetRoll list:%2\"]").arg(dotId(), m_values.join(","));
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ListSetRollNode::getPriority() const
@@ -73,12 +75,13 @@ void ListSetRollNode::run(ExecutionNode* previous)
             else
             {
                 m_result->setPrevious(result);
+                compileRanges();
                 for(quint64 i= 0; i < diceCount; ++i)
                 {
                     QStringList rollResult;
                     Die* die= new Die();
                     computeFacesNumber(die);
-                    die->roll();
+                    die->roll(false, m_randomEngine.get());
                     m_diceResult->insertResult(die);
                     getValueFromDie(die, rollResult);
                     for(auto str : rollResult)
@@ -98,6 +101,7 @@ void ListSetRollNode::run(ExecutionNode* previous)
 void ListSetRollNode::setListValue(QStringList lirs)
 {
     m_values= lirs;
+    m_compiled= false;
 }
 void ListSetRollNode::setUnique(bool u)
 {
@@ -106,29 +110,66 @@ void ListSetRollNode::setUnique(bool u)
 void ListSetRollNode::setRangeList(QList<Range>& ranges)
 {
     m_rangeList= ranges;
+    m_compiled= false;
 }
-void ListSetRollNode::computeFacesNumber(Die* die)
+void ListSetRollNode::compileRanges()
 {
+    if(m_compiled)
+        return;
+    m_compiled= true;
+    m_segments.clear();
     if(m_rangeList.isEmpty())
     {
-        die->setMaxValue(m_values.size());
+        m_faces= m_values.size();
+        return;
     }
-    else
+
+    Q_ASSERT(m_values.size() == m_rangeList.size());
+    m_faces= 0;
+    int i= 0;
+    std::vector<qint64> bounds;
+    for(Range& range : m_rangeList)
     {
-        Q_ASSERT(m_values.size() == m_rangeList.size());
-        qint64 max;
-        int i= 0;
+        if(((i == 0) || (m_faces < range.getEnd())) && (range.isFullyDefined()))
+        {
+            m_faces= range.getEnd();
+        }
+        bounds.push_back(range.getStart());
+        bounds.push_back(range.getEnd() + 1);
+        ++i;
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    // between two consecutive bounds, every value matches the same ranges.
+    for(std::size_t b= 0; b + 1 < bounds.size(); ++b)
+    {
+        Segment segment{bounds[b], bounds[b + 1] - 1, {}};
+        int index= 0;
         for(Range& range : m_rangeList)
         {
-            if(((i == 0) || (max < range.getEnd())) && (range.isFullyDefined()))
-            {
-                max= range.getEnd();
-            }
-            ++i;
+            if(range.getStart() <= segment.start && segment.start <= range.getEnd())
+                segment.ranges.push_back(index);
+            ++index;
         }
-        die->setMaxValue(max);
+        if(!segment.ranges.empty())
+            m_segments.push_back(segment);
     }
 }
+const ListSetRollNode::Segment* ListSetRollNode::findSegment(qint64 value) const
+{
+    auto it= std::upper_bound(m_segments.begin(), m_segments.end(), value,
+                              [](qint64 val, const Segment& segment) { return val < segment.start; });
+    if(it == m_segments.begin())
+        return nullptr;
+    --it;
+    return value <= it->end ? &(*it) : nullptr;
+}
+void ListSetRollNode::computeFacesNumber(Die* die)
+{
+    compileRanges();
+    die->setMaxValue(m_faces);
+}
 void ListSetRollNode::getValueFromDie(Die* die, QStringList& rollResult)
 {
     if(m_rangeList.isEmpty())
@@ -138,7 +179,7 @@ void ListSetRollNode::getValueFromDie(Die* die, QStringList& rollResult)
             auto str= m_values[die->getValue() - 1];
             while(m_unique && rollResult.contains(str))
             {
-                die->roll(false);
+                die->roll(false, m_randomEngine.get());
                 str= m_values[die->getValue() - 1];
             }
             rollResult << str;
@@ -150,22 +191,23 @@ void ListSetRollNode::getValueFromDie(Die* die, QStringList& rollResult)
         bool found= false;
         while(!found)
         {
-            int i= 0;
-            for(Range& range : m_rangeList)
+            auto segment= findSegment(die->getLastRolledValue());
+            if(nullptr != segment)
             {
-                auto it= std::find(m_rangeIndexResult.begin(), m_rangeIndexResult.end(), i);
-                auto isValid= range.hasValid(die, false);
-                if((isValid && !m_unique) || (isValid && it == m_rangeIndexResult.end()))
+                for(auto i : segment->ranges)
                 {
-                    m_rangeIndexResult.push_back(i);
-                    rollResult << m_values[i];
-                    found= true;
+                    auto it= std::find(m_rangeIndexResult.begin(), m_rangeIndexResult.end(), i);
+                    if(!m_unique || it == m_rangeIndexResult.end())
+                    {
+                        m_rangeIndexResult.push_back(i);
+                        rollResult << m_values[i];
+                        found= true;
+                    }
                 }
-                ++i;
             }
             if(!found)
             {
-                die->roll(false);
+                die->roll(false, m_randomEngine.get());
             }
         }
     }
@@ -177,9 +219,27 @@ ExecutionNode* ListSetRollNode::getCopy() const
     node->setRangeList(dataList);
     node->setUnique(m_unique);
     node->setListValue(m_values);
+    node->setRandomEngine(m_randomEngine);
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
     }
     return node;
 }
+
+bool ListSetRollNode::reset()
+{
+    m_diceResult->reset();
+    m_rangeIndexResult.clear();
+    return ExecutionNode::reset();
+}
+
+void ListSetRollNode::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+const std::shared_ptr<RandomEngine>& ListSetRollNode::getRandomEngine() const
+{
+    return m_randomEngine;
+}
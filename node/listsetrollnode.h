@@ -22,11 +22,15 @@
 #define LISTSETROLLNODE_H
 
 #include <QStringList>
+#include <memory>
+#include <vector>
 
 #include "executionnode.h"
 #include "range.h"
 #include "result/diceresult.h"
 #include "result/stringresult.h"
+
+class RandomEngine;
 /**
  * @brief The ListSetRollNode class is dedicated to pick up item from list.
  */
@@ -44,10 +48,25 @@ public:
     void setUnique(bool);
     void setRangeList(QList<Range>&);
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
+
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    const std::shared_ptr<RandomEngine>& getRandomEngine() const;
 
 private:
+    /**
+     * @brief The Segment struct is a run of die values matching the same ranges.
+     */
+    struct Segment
+    {
+        qint64 start;
+        qint64 end;
+        std::vector<int> ranges;
+    };
     void getValueFromDie(Die* die, QStringList& rollResult);
     void computeFacesNumber(Die* die);
+    void compileRanges();
+    const Segment* findSegment(qint64 value) const;
 
 private:
     QStringList m_values;
@@ -56,6 +75,10 @@ private:
     std::vector<int> m_rangeIndexResult;
     bool m_unique;
     QList<Range> m_rangeList;
+    std::vector<Segment> m_segments;
+    qint64 m_faces= 0;
+    bool m_compiled= false;
+    std::shared_ptr<RandomEngine> m_randomEngine;
 };
 
 #endif // LISTSETROLLNODE_H
@@ -59,7 +59,7 @@ void MergeNode::run(ExecutionNode* previous)
         Result* tmpResult= last->getResult();
         while(nullptr != tmpResult)
         {
-            DiceResult* dice= dynamic_cast<DiceResult*>(tmpResult);
+            DiceResult* dice= Result::asDice(tmpResult);
             if(nullptr != dice)
             {
                 ///@todo TODO improve here to set homogeneous while is really
@@ -113,11 +113,11 @@ QString MergeNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"Merge Node\"]").arg(m_id);
+        return QString("%1 [label=\"Merge Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 MergeNode::getPriority() const
@@ -132,6 +132,7 @@ qint64 MergeNode::getPriority() const
 ExecutionNode* MergeNode::getCopy() const
 {
     MergeNode* node= new MergeNode();
+    node->setStartList(copyStartList(m_startList));
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -139,6 +140,12 @@ ExecutionNode* MergeNode::getCopy() const
     return node;
 }
 
+bool MergeNode::reset()
+{
+    // instructions are linked together while running.
+    return false;
+}
+
 std::vector<ExecutionNode*>* MergeNode::getStartList() const
 {
     return m_startList;
@@ -36,6 +36,7 @@ public:
     virtual QString toString(bool withLabel) const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
     std::vector<ExecutionNode*>* getStartList() const;
     void setStartList(std::vector<ExecutionNode*>* startList);
 
@@ -52,15 +52,19 @@ void NumberNode::setNumber(qint64 a)
     m_scalarResult->setValue(a);
     m_number= a;
 }
+qint64 NumberNode::getNumber() const
+{
+    return m_number;
+}
 QString NumberNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"NumberNode %2\"]").arg(m_id).arg(m_number);
+        return QString("%1 [label=\"NumberNode %2\"]").arg(dotId()).arg(m_number);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 NumberNode::getPriority() const
@@ -82,3 +86,10 @@ ExecutionNode* NumberNode::getCopy() const
     }
     return node;
 }
+
+bool NumberNode::reset()
+{
+    // the number is given by the parser, it does not change from one run to the other.
+    m_errors.clear();
+    return resetNext();
+}
@@ -35,9 +35,11 @@ public:
     virtual ~NumberNode();
     void run(ExecutionNode* previous);
     void setNumber(qint64);
+    qint64 getNumber() const;
     virtual QString toString(bool withLabel) const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
 
 private:
     qint64 m_number;
@@ -25,6 +25,11 @@
 
 OccurenceCountNode::OccurenceCountNode() : ExecutionNode() {}
 
+OccurenceCountNode::~OccurenceCountNode()
+{
+    delete m_validatorList;
+}
+
 void OccurenceCountNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
@@ -32,23 +37,42 @@ void OccurenceCountNode::run(ExecutionNode* previous)
     if(nullptr == m_previousNode)
         return;
 
-    DiceResult* previousDiceResult= dynamic_cast<DiceResult*>(m_previousNode->getResult());
+    DiceResult* previousDiceResult= Result::asDice(m_previousNode->getResult());
     if(nullptr == previousDiceResult)
         return;
 
-    auto const& diceList= previousDiceResult->getResultList();
     QVector<qint64> vec;
 
-    for(auto dice : diceList)
+    if(auto histogram= previousDiceResult->histogram())
     {
-        auto val= dice->getValue();
-
-        vec << val;
-        auto it= mapOccurence.find(val);
-        if(it == mapOccurence.end())
-            mapOccurence[val]= 1;
-        else
-            mapOccurence[val]+= 1;
+        // occurrences are the buckets themselves.
+        for(std::size_t b= 0; b < histogram->bucketCount(); ++b)
+        {
+            auto const& bucket= histogram->bucket(b);
+            mapOccurence[bucket.value]+= static_cast<qint64>(bucket.count);
+        }
+        if(nullptr == m_nextNode)
+        {
+            for(auto const& occurence : mapOccurence)
+            {
+                for(qint64 i= 0; i < occurence.second; ++i)
+                    vec << occurence.first;
+            }
+        }
+    }
+    else
+    {
+        for(const auto& dice : previousDiceResult->view())
+        {
+            auto val= dice.getValue();
+
+            vec << val;
+            auto it= mapOccurence.find(val);
+            if(it == mapOccurence.end())
+                mapOccurence[val]= 1;
+            else
+                mapOccurence[val]+= 1;
+        }
     }
 
     std::sort(vec.begin(), vec.end());
@@ -65,16 +89,27 @@ QString OccurenceCountNode::toString(bool label) const
 {
     if(label)
     {
-        return QString("%1 [label=\"OccurenceCountNode %2\"]").arg(m_id);
+        return QString("%1 [label=\"OccurenceCountNode %2\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 ExecutionNode* OccurenceCountNode::getCopy() const
 {
-    return nullptr;
+    OccurenceCountNode* node= new OccurenceCountNode();
+    node->setWidth(m_width);
+    node->setHeight(m_height);
+    if(nullptr != m_validatorList)
+    {
+        node->setValidatorList(m_validatorList->getCopy());
+    }
+    if(nullptr != m_nextNode)
+    {
+        node->setNextNode(m_nextNode->getCopy());
+    }
+    return node;
 }
 qint64 OccurenceCountNode::getPriority() const
 {
@@ -29,6 +29,7 @@ class OccurenceCountNode : public ExecutionNode
 {
 public:
     OccurenceCountNode();
+    virtual ~OccurenceCountNode();
 
     void run(ExecutionNode* previous= nullptr);
     virtual QString toString(bool withLabel) const;
@@ -67,7 +67,7 @@ void PainterNode::run(ExecutionNode* previous)
     if(nullptr == previousResult)
         return;
 
-    m_diceResult= dynamic_cast<DiceResult*>(previousResult->getCopy());
+    m_diceResult= Result::asDice(previousResult->getCopy());
     if(nullptr != m_diceResult)
     {
         QList<Die*> diceList= m_diceResult->getResultList();
@@ -96,11 +96,11 @@ QString PainterNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"PainterNode\"]").arg(m_id);
+        return QString("%1 [label=\"PainterNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -117,6 +117,8 @@ void PainterNode::insertColorItem(QString color, int value)
 ExecutionNode* PainterNode::getCopy() const
 {
     PainterNode* node= new PainterNode();
+    for(auto const& item : m_colors)
+        node->insertColorItem(item.color(), item.colorNumber());
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
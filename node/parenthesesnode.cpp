@@ -26,6 +26,10 @@ void ParenthesesNode::setInternelNode(ExecutionNode* node)
 {
     m_internalNode= node;
 }
+ExecutionNode* ParenthesesNode::getInternalNode() const
+{
+    return m_internalNode;
+}
 void ParenthesesNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
@@ -49,11 +53,11 @@ QString ParenthesesNode::toString(bool b) const
 {
     if(b)
     {
-        return QString("%1 [label=\"ParenthesesNode\"]").arg(m_id);
+        return QString("%1 [label=\"ParenthesesNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ParenthesesNode::getPriority() const
@@ -75,6 +79,12 @@ ExecutionNode* ParenthesesNode::getCopy() const
     return node;
 }
 
+bool ParenthesesNode::reset()
+{
+    bool internal= nullptr == m_internalNode || m_internalNode->reset();
+    return ExecutionNode::reset() && internal;
+}
+
 void ParenthesesNode::generateDotTree(QString& s)
 {
     auto str= toString(true);
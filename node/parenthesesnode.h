@@ -34,9 +34,11 @@ public:
     virtual void run(ExecutionNode* previous= nullptr);
 
     void setInternelNode(ExecutionNode* node);
+    ExecutionNode* getInternalNode() const;
     virtual QString toString(bool) const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
     virtual void generateDotTree(QString&);
 
 private:
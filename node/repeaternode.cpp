@@ -22,10 +22,20 @@
 #include "node/repeaternode.h"
 
 #include "diceparserhelper.h"
+#include "executionbudget.h"
 #include "executionnode.h"
+#include "instructionschedule.h"
 #include "parsingtoolbox.h"
+#include "randomengine.h"
 #include "result/stringresult.h"
 #include <QDebug>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 
 using InstructionSet= std::vector<ExecutionNode*>;
 
@@ -60,8 +70,149 @@ std::vector<ExecutionNode*> makeCopy(std::vector<ExecutionNode*> cmds)
     return copy;
 }
 
+namespace
+{
+// with fewer turns for each thread, starting threads costs more than it saves.
+constexpr int minTurnsPerThread= 16;
+
+struct Turn
+{
+    bool done= false;
+    qreal sum= 0.0;
+    QString text;
+};
+
+/**
+ * @brief The Schedule struct holds the turns of one run of a repeater, shared by the threads running them.
+ */
+struct Schedule
+{
+    std::vector<Turn> turns;
+    std::atomic<int> next;
+    quint64 seed= 0;
+    ExecutionBudget* budget= nullptr;
+};
+
+/**
+ * @brief The TurnWorker class runs turns on its own copy of the command, reset between two turns. Each turn draws
+ * from its own stream, so its result does not depend on the thread running it. Streams are xoshiro256** whatever the
+ * parser engine: seeding it costs four splitmix64 steps, where a mt19937 would fill 624 words at each turn.
+ */
+class TurnWorker
+{
+public:
+    TurnWorker(RepeaterNode* repeater, Schedule& schedule)
+        : m_repeater(repeater)
+        , m_schedule(schedule)
+        , m_cmd(makeCopy(repeater->getCommand()))
+        , m_engine(new Xoshiro256Engine(schedule.seed))
+    {
+    }
+
+    ~TurnWorker()
+    {
+        for(auto node : m_cmd)
+            delete node;
+    }
+
+    /**
+     * @brief prepare makes the command ready for a new turn.
+     * @return true if the command could be reset, false if it had to be copied.
+     */
+    bool prepare()
+    {
+        if(m_fresh)
+            return m_reusable;
+        m_reusable= m_reusable
+                    && std::all_of(m_cmd.begin(), m_cmd.end(), [](ExecutionNode* node) { return node->reset(); });
+        if(!m_reusable)
+        {
+            for(auto node : m_cmd)
+                delete node;
+            m_cmd= makeCopy(m_repeater->getCommand());
+        }
+        m_fresh= true;
+        return m_reusable;
+    }
+
+    void runTurn(int index)
+    {
+        prepare();
+        m_fresh= false;
+        m_engine->seed(RandomEngine::streamSeed(m_schedule.seed, static_cast<quint64>(index)));
+        auto previousBudget= ExecutionBudget::setCurrent(m_schedule.budget);
+        auto previousEngine= RandomEngine::setThreadOverride(m_engine.get());
+
+        auto& turn= m_schedule.turns[static_cast<std::size_t>(index)];
+        for(auto node : m_cmd)
+        {
+            node->run(m_repeater);
+            auto leafResult= ParsingToolBox::getLeafNode(node)->getResult();
+            if(m_repeater->isSumAll() && nullptr != leafResult)
+                turn.sum+= leafResult->getResult(Dice::RESULT_TYPE::SCALAR).toDouble();
+        }
+        if(!m_repeater->isSumAll())
+        {
+            m_formatter.setStartNodes(m_cmd);
+            turn.text
+                = m_formatter.finalStringResult([](const QString& result, const QString&, bool) { return result; });
+        }
+        turn.done= true;
+
+        RandomEngine::setThreadOverride(previousEngine);
+        ExecutionBudget::setCurrent(previousBudget);
+    }
+
+    /**
+     * @brief runAll runs turns until none is left.
+     */
+    void runAll()
+    {
+        auto previousBudget= ExecutionBudget::setCurrent(m_schedule.budget);
+        auto count= static_cast<int>(m_schedule.turns.size());
+        for(int i= m_schedule.next++; i < count && !ExecutionBudget::interrupted(); i= m_schedule.next++)
+            runTurn(i);
+        ExecutionBudget::setCurrent(previousBudget);
+    }
+
+private:
+    RepeaterNode* m_repeater;
+    Schedule& m_schedule;
+    std::vector<ExecutionNode*> m_cmd;
+    std::unique_ptr<RandomEngine> m_engine;
+    ParsingToolBox m_formatter;
+    bool m_fresh= true;
+    bool m_reusable= true;
+};
+
+class TurnTask : public QRunnable
+{
+public:
+    TurnTask(const std::shared_ptr<TurnWorker>& worker, QSemaphore& finished)
+        : m_worker(worker), m_finished(finished)
+    {
+    }
+    void run() override
+    {
+        m_worker->runAll();
+        m_finished.release();
+    }
+
+private:
+    std::shared_ptr<TurnWorker> m_worker;
+    QSemaphore& m_finished;
+};
+} // namespace
+
 RepeaterNode::RepeaterNode() {}
 
+RepeaterNode::~RepeaterNode()
+{
+    for(auto node : m_cmd)
+        delete node;
+    delete m_times;
+}
+
 void RepeaterNode::run(ExecutionNode* previousNode)
 {
     m_previousNode= previousNode;
@@ -70,52 +221,66 @@ void RepeaterNode::run(ExecutionNode* previousNode)
         return;
 
     m_times->run(this);
-    m_times= ParsingToolBox::getLeafNode(m_times);
-    auto times= m_times->getResult();
+    auto timeLeaf= ParsingToolBox::getLeafNode(m_times);
+    auto times= timeLeaf->getResult();
     if(!times)
         return;
 
-    std::vector<InstructionSet> m_startingNodes;
-    auto timeCount= times->getResult(Dice::RESULT_TYPE::SCALAR).toInt();
-    auto cmd= makeCopy(m_cmd);
-    std::vector<Result*> resultVec;
-    for(int i= 0; i < timeCount; ++i)
+    auto timeCount= std::max(0, times->getResult(Dice::RESULT_TYPE::SCALAR).toInt());
+    // one draw of the parser engine seeds the streams of all turns.
+    auto source= RandomEngine::select(nullptr);
+    Schedule schedule;
+    schedule.turns.resize(static_cast<std::size_t>(timeCount));
+    schedule.next= 0;
+    schedule.seed= source->next();
+    schedule.budget= ExecutionBudget::current();
+
+    // the first turn runs alone: other threads only help once it has shown the command can be reset.
+    TurnWorker caller(this, schedule);
+    QSemaphore finished;
+    int helpers= 0;
+    if(timeCount > 0 && !ExecutionBudget::interrupted())
     {
-        m_startingNodes.push_back(cmd);
-        std::for_each(cmd.begin(), cmd.end(), [this, &resultVec](ExecutionNode* node) {
-            node->run(this);
-            auto end= ParsingToolBox::getLeafNode(node);
-            auto leafResult= end->getResult();
-
-            if(nullptr == leafResult)
-                return;
-
-            resultVec.push_back(leafResult);
-        });
-        cmd= makeCopy(m_cmd);
+        schedule.next= 1;
+        caller.runTurn(0);
+        auto pool= QThreadPool::globalInstance();
+        // $n, merge and bind touch the results of other instructions: turns then run one after the other.
+        auto wanted= m_readsResults ? 0 : std::min(pool->maxThreadCount(), timeCount / minTurnsPerThread) - 1;
+        while(caller.prepare() && helpers < wanted)
+        {
+            auto task= new TurnTask(std::make_shared<TurnWorker>(this, schedule), finished);
+            if(!pool->tryStart(task))
+            {
+                delete task;
+                break;
+            }
+            ++helpers;
+        }
+    }
+    caller.runAll();
+    finished.acquire(helpers);
+
+    // turns are gathered in their order, whatever thread ran them.
+    qreal sum= 0.0;
+    QStringList listOfStrResult;
+    for(auto const& turn : schedule.turns)
+    {
+        if(!turn.done)
+            continue;
+        sum+= turn.sum;
+        listOfStrResult << turn.text;
     }
+
+    delete m_result;
     if(m_sumAll)
     {
         auto scalar= new ScalarResult();
-        qreal value= 0.0;
-        std::for_each(resultVec.begin(), resultVec.end(),
-                      [&value](Result* result) { value+= result->getResult(Dice::RESULT_TYPE::SCALAR).toDouble(); });
-        scalar->setValue(value);
+        scalar->setValue(sum);
         m_result= scalar;
     }
     else
     {
         auto string= new StringResult();
-
-        QStringList listOfStrResult;
-        for(auto instructions : m_startingNodes)
-        {
-            ParsingToolBox parsingBox;
-            parsingBox.setStartNodes(instructions);
-            auto finalString
-                = parsingBox.finalStringResult([](const QString& result, const QString&, bool) { return result; });
-            listOfStrResult << finalString;
-        }
         if(!listOfStrResult.isEmpty())
             string->addText(listOfStrResult.join('\n'));
 
@@ -140,12 +305,35 @@ qint64 RepeaterNode::getPriority() const
 
 ExecutionNode* RepeaterNode::getCopy() const
 {
-    return nullptr;
+    RepeaterNode* node= new RepeaterNode();
+    node->setCommand(makeCopy(m_cmd));
+    if(nullptr != m_times)
+    {
+        node->setTimeNode(m_times->getCopy());
+    }
+    node->setSumAll(m_sumAll);
+    if(nullptr != m_nextNode)
+    {
+        node->setNextNode(m_nextNode->getCopy());
+    }
+    return node;
+}
+
+bool RepeaterNode::reset()
+{
+    bool times= nullptr == m_times || m_times->reset();
+    return ExecutionNode::reset() && times;
 }
 
 void RepeaterNode::setCommand(const std::vector<ExecutionNode*>& cmd)
 {
     m_cmd= cmd;
+    m_readsResults= InstructionSchedule::readsResults(m_cmd);
+}
+
+const std::vector<ExecutionNode*>& RepeaterNode::getCommand() const
+{
+    return m_cmd;
 }
 
 void RepeaterNode::setTimeNode(ExecutionNode* time)
@@ -153,7 +341,17 @@ void RepeaterNode::setTimeNode(ExecutionNode* time)
     m_times= time;
 }
 
+ExecutionNode* RepeaterNode::getTimeNode() const
+{
+    return m_times;
+}
+
 void RepeaterNode::setSumAll(bool b)
 {
     m_sumAll= b;
 }
+
+bool RepeaterNode::isSumAll() const
+{
+    return m_sumAll;
+}
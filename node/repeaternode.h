@@ -29,20 +29,27 @@ class RepeaterNode : public ExecutionNode
 {
 public:
     RepeaterNode();
+    virtual ~RepeaterNode() override;
     void run(ExecutionNode* previous) override;
     virtual QString toString(bool withLabel) const override;
     virtual qint64 getPriority() const override;
 
     virtual ExecutionNode* getCopy() const override;
 
+    virtual bool reset() override;
+
     void setCommand(const std::vector<ExecutionNode*>& node);
+    const std::vector<ExecutionNode*>& getCommand() const;
     void setTimeNode(ExecutionNode* times);
+    ExecutionNode* getTimeNode() const;
     void setSumAll(bool b);
+    bool isSumAll() const;
 
 private:
     std::vector<ExecutionNode*> m_cmd;
     ExecutionNode* m_times= nullptr;
     bool m_sumAll= false;
+    bool m_readsResults= false;
 };
 
 #endif // REPEATER_NODE_H
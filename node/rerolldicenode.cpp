@@ -1,5 +1,7 @@
 #include "rerolldicenode.h"
+#include "executionbudget.h"
 #include "parsingtoolbox.h"
+#include "randomengine.h"
 #include <utility>
 
 RerollDiceNode::RerollDiceNode(bool reroll, bool addingMode)
@@ -14,13 +16,14 @@ RerollDiceNode::~RerollDiceNode()
         delete m_validatorList;
         m_validatorList= nullptr;
     }
+    delete m_instruction;
 }
 void RerollDiceNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
     if((nullptr != previous) && (nullptr != previous->getResult()))
     {
-        DiceResult* previous_result= dynamic_cast<DiceResult*>(previous->getResult());
+        DiceResult* previous_result= Result::asDice(previous->getResult());
         m_result->setPrevious(previous_result);
         if(nullptr != previous_result)
         {
@@ -51,7 +54,7 @@ void RerollDiceNode::run(ExecutionNode* previous)
                                                  .arg(static_cast<int>(die->getMaxValue()))));
                     continue;
                 }
-                while(m_validatorList->hasValid(die, false) && !finished)
+                while(m_validatorList->hasValid(die, false) && !finished && !ExecutionBudget::interrupted())
                 {
                     if(m_instruction != nullptr)
                     {
@@ -59,7 +62,7 @@ void RerollDiceNode::run(ExecutionNode* previous)
                         auto lastNode= ParsingToolBox::getLatestNode(m_instruction);
                         if(lastNode != nullptr)
                         {
-                            auto lastResult= dynamic_cast<DiceResult*>(lastNode->getResult());
+                            auto lastResult= Result::asDice(lastNode->getResult());
                             if(lastResult != nullptr)
                             {
                                 toRemove.append(die);
@@ -70,7 +73,7 @@ void RerollDiceNode::run(ExecutionNode* previous)
                     }
                     else
                     {
-                        die->roll(m_adding);
+                        die->roll(m_adding, m_randomEngine.get());
                     }
                     if(m_reroll)
                     {
@@ -102,15 +105,27 @@ void RerollDiceNode::setValidatorList(ValidatorList* val)
 {
     m_validatorList= val;
 }
+ValidatorList* RerollDiceNode::getValidatorList() const
+{
+    return m_validatorList;
+}
+bool RerollDiceNode::isRerollOnce() const
+{
+    return m_reroll;
+}
+bool RerollDiceNode::isAdding() const
+{
+    return m_adding;
+}
 QString RerollDiceNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"RerollDiceNode validatior: %2\"]").arg(m_id, m_validatorList->toString());
+        return QString("%1 [label=\"RerollDiceNode validatior: %2\"]").arg(dotId(), m_validatorList->toString());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
     // return QString("RerollDiceNode [label=\"RerollDiceNode validatior:%1\"");
 }
@@ -127,7 +142,15 @@ qint64 RerollDiceNode::getPriority() const
 ExecutionNode* RerollDiceNode::getCopy() const
 {
     RerollDiceNode* node= new RerollDiceNode(m_reroll, m_adding);
-    node->setValidatorList(m_validatorList);
+    if(nullptr != m_validatorList)
+    {
+        node->setValidatorList(m_validatorList->getCopy());
+    }
+    if(nullptr != m_instruction)
+    {
+        node->setInstruction(m_instruction->getCopy());
+    }
+    node->setRandomEngine(m_randomEngine);
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
@@ -135,6 +158,12 @@ ExecutionNode* RerollDiceNode::getCopy() const
     return node;
 }
 
+bool RerollDiceNode::reset()
+{
+    bool instruction= nullptr == m_instruction || m_instruction->reset();
+    return ExecutionNode::reset() && instruction;
+}
+
 ExecutionNode* RerollDiceNode::getInstruction() const
 {
     return m_instruction;
@@ -144,3 +173,13 @@ void RerollDiceNode::setInstruction(ExecutionNode* instruction)
 {
     m_instruction= instruction;
 }
+
+void RerollDiceNode::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+const std::shared_ptr<RandomEngine>& RerollDiceNode::getRandomEngine() const
+{
+    return m_randomEngine;
+}
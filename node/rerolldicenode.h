@@ -1,10 +1,13 @@
 #ifndef REROLLDICENODE_H
 #define REROLLDICENODE_H
 
+#include <memory>
+
 #include "executionnode.h"
 #include "result/diceresult.h"
 
 class ValidatorList;
+class RandomEngine;
 /**
  * @brief The RerollDiceNode class reroll dice given a condition and replace(or add) the result.
  */
@@ -40,6 +43,13 @@ public:
      * @brief setValidator
      */
     virtual void setValidatorList(ValidatorList*);
+    ValidatorList* getValidatorList() const;
+    /**
+     * @brief isRerollOnce
+     * @return true if dice are rerolled only once, false if they are rerolled until the condition is false.
+     */
+    bool isRerollOnce() const;
+    bool isAdding() const;
     /**
      * @brief toString
      * @return
@@ -56,14 +66,19 @@ public:
      * @return
      */
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
 
     ExecutionNode* getInstruction() const;
     void setInstruction(ExecutionNode* instruction);
 
+    void setRandomEngine(const std::shared_ptr<RandomEngine>& engine);
+    const std::shared_ptr<RandomEngine>& getRandomEngine() const;
+
 private:
     DiceResult* m_diceResult= nullptr;
     ValidatorList* m_validatorList= nullptr;
     ExecutionNode* m_instruction= nullptr;
+    std::shared_ptr<RandomEngine> m_randomEngine;
 
     const bool m_reroll;
     const bool m_adding;
@@ -124,6 +124,10 @@ void ScalarOperatorNode::setInternalNode(ExecutionNode* node)
 {
     m_internalNode= node;
 }
+ExecutionNode* ScalarOperatorNode::getInternalNode() const
+{
+    return m_internalNode;
+}
 qint64 ScalarOperatorNode::add(qreal a, qreal b)
 {
     return static_cast<qint64>(a + b);
@@ -185,11 +189,11 @@ QString ScalarOperatorNode::toString(bool wl) const
     }
     if(wl)
     {
-        return QString("%1 [label=\"ScalarOperatorNode %2\"]").arg(m_id, op);
+        return QString("%1 [label=\"ScalarOperatorNode %2\"]").arg(dotId(), op);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ScalarOperatorNode::getPriority() const
@@ -283,3 +287,9 @@ ExecutionNode* ScalarOperatorNode::getCopy() const
     }
     return node;
 }
+
+bool ScalarOperatorNode::reset()
+{
+    bool internal= nullptr == m_internalNode || m_internalNode->reset();
+    return ExecutionNode::reset() && internal;
+}
@@ -56,6 +56,7 @@ public:
      * @param node
      */
     void setInternalNode(ExecutionNode* node);
+    ExecutionNode* getInternalNode() const;
     /**
      * @brief toString
      * @param wl
@@ -93,6 +94,7 @@ public:
      * @return
      */
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
 
 private:
     /**
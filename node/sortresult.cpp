@@ -36,11 +36,25 @@ void SortResultNode::run(ExecutionNode* node)
     {
         return;
     }
-    DiceResult* previousDiceResult= dynamic_cast<DiceResult*>(node->getResult());
+    DiceResult* previousDiceResult= Result::asDice(node->getResult());
     m_diceResult->setPrevious(previousDiceResult);
     if(nullptr == previousDiceResult)
         return;
 
+    if(auto histogram= previousDiceResult->histogram())
+    {
+        // buckets are sorted instead of dice.
+        DiceHistogram sorted= *histogram;
+        sorted.sort(m_ascending);
+        histogram->setFlagOnAll(CompactDiceList::Displayed, true);
+        m_diceResult->setHistogram(sorted);
+        if(nullptr != m_nextNode)
+        {
+            m_nextNode->run(this);
+        }
+        return;
+    }
+
     auto const& diceList= previousDiceResult->getResultList();
     QList<Die*> diceList2= m_diceResult->getResultList();
 
@@ -116,16 +130,20 @@ void SortResultNode::setSortAscending(bool asc)
 {
     m_ascending= asc;
 }
+bool SortResultNode::isAscending() const
+{
+    return m_ascending;
+}
 QString SortResultNode::toString(bool wl) const
 {
     if(wl)
     {
         auto order= m_ascending ? QStringLiteral("Ascending") : QStringLiteral("Descending");
-        return QString("%1 [label=\"SortResultNode %2\"]").arg(m_id, order);
+        return QString("%1 [label=\"SortResultNode %2\"]").arg(dotId(), order);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 SortResultNode::getPriority() const
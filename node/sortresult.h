@@ -45,6 +45,7 @@ public:
      * @param asc
      */
     void setSortAscending(bool asc);
+    bool isAscending() const;
     /**
      * @brief toString
      * @return
@@ -35,7 +35,7 @@ void SplitNode::run(ExecutionNode* previous)
         Result* tmpResult= previous->getResult();
         if(nullptr != tmpResult)
         {
-            DiceResult* dice= dynamic_cast<DiceResult*>(tmpResult);
+            DiceResult* dice= Result::asDice(tmpResult);
             if(nullptr != dice)
             {
                 for(auto& oldDie : dice->getResultList())
@@ -66,11 +66,11 @@ QString SplitNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"SplitNode Node\"]").arg(m_id);
+        return QString("%1 [label=\"SplitNode Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 SplitNode::getPriority() const
@@ -33,11 +33,11 @@ QString StartingNode::toString(bool withlabel) const
 {
     if(withlabel)
     {
-        return QString("%1 [label=\"StartingNode\"]").arg(m_id);
+        return QString("%1 [label=\"StartingNode\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
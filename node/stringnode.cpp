@@ -30,11 +30,11 @@ QString StringNode::toString(bool withLabel) const
     {
         QString dataCopy= m_data;
 
-        return QString("%1 [label=\"StringNode %2\"]").arg(m_id, dataCopy.replace('%', '\\'));
+        return QString("%1 [label=\"StringNode %2\"]").arg(dotId(), dataCopy.replace('%', '\\'));
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 StringNode::getPriority() const
@@ -56,3 +56,10 @@ ExecutionNode* StringNode::getCopy() const
     }
     return node;
 }
+
+bool StringNode::reset()
+{
+    // the text is given by the parser, it does not change from one run to the other.
+    m_errors.clear();
+    return resetNext();
+}
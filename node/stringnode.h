@@ -20,6 +20,7 @@ public:
      * @return
      */
     virtual ExecutionNode* getCopy() const;
+    virtual bool reset();
 
 private:
     QString m_data;
@@ -34,7 +34,7 @@ void UniqueNode::run(ExecutionNode* previous)
         Result* tmpResult= previous->getResult();
         if(nullptr != tmpResult)
         {
-            DiceResult* dice= dynamic_cast<DiceResult*>(tmpResult);
+            DiceResult* dice= Result::asDice(tmpResult);
             if(nullptr != dice)
             {
                 auto const& resultList= dice->getResultList();
@@ -66,11 +66,11 @@ QString UniqueNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"UniqueNode Node\"]").arg(m_id);
+        return QString("%1 [label=\"UniqueNode Node\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 UniqueNode::getPriority() const
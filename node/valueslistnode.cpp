@@ -7,6 +7,12 @@ ValuesListNode::ValuesListNode() : m_diceResult(new DiceResult())
     m_result= m_diceResult;
 }
 
+ValuesListNode::~ValuesListNode()
+{
+    for(auto node : m_data)
+        delete node;
+}
+
 void ValuesListNode::run(ExecutionNode* previous)
 {
     m_previousNode= previous;
@@ -35,24 +41,41 @@ void ValuesListNode::insertValue(ExecutionNode* value)
 {
     m_data.push_back(value);
 }
+const std::vector<ExecutionNode*>& ValuesListNode::getValues() const
+{
+    return m_data;
+}
+void ValuesListNode::setValues(const std::vector<ExecutionNode*>& values)
+{
+    m_data= values;
+}
 ExecutionNode* ValuesListNode::getCopy() const
 {
     ValuesListNode* node= new ValuesListNode();
+    for(auto value : m_data)
+        node->insertValue(value->getCopy());
     if(nullptr != m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
     }
     return node;
 }
+bool ValuesListNode::reset()
+{
+    bool values= true;
+    for(auto node : m_data)
+        values= node->reset() && values;
+    return ExecutionNode::reset() && values;
+}
 QString ValuesListNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QString("%1 [label=\"ValuesListNode list:\"]").arg(m_id);
+        return QString("%1 [label=\"ValuesListNode list:\"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 ValuesListNode::getPriority() const
@@ -8,13 +8,17 @@ class ValuesListNode : public ExecutionNode
 {
 public:
     ValuesListNode();
+    virtual ~ValuesListNode() override;
 
     virtual void run(ExecutionNode* previous= nullptr) override;
     virtual QString toString(bool) const override;
     virtual qint64 getPriority() const override;
     virtual ExecutionNode* getCopy() const override;
+    virtual bool reset() override;
 
     void insertValue(ExecutionNode*);
+    const std::vector<ExecutionNode*>& getValues() const;
+    void setValues(const std::vector<ExecutionNode*>& values);
 
 private:
     std::vector<ExecutionNode*> m_data;
@@ -15,7 +15,7 @@ void VariableNode::run(ExecutionNode* previous)
             if(result)
             {
                 auto copy= result->getCopy();
-                auto diceResult= dynamic_cast<DiceResult*>(result);
+                auto diceResult= Result::asDice(result);
                 if(nullptr != diceResult)
                 {
                     for(auto& die : diceResult->getResultList())
@@ -41,11 +41,11 @@ QString VariableNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"VariableNode index: %2\"]").arg(m_id).arg(m_index + 1);
+        return QString("%1 [label=\"VariableNode index: %2\"]").arg(dotId()).arg(m_index + 1);
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 
@@ -65,7 +65,7 @@ ExecutionNode* VariableNode::getCopy() const
     node->setIndex(m_index);
     if(nullptr != m_data)
     {
-        node->setData(m_data);
+        node->setData(copyStartList(m_data));
     }
     if(nullptr != m_nextNode)
     {
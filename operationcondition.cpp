@@ -20,6 +20,8 @@
 
 #include "operationcondition.h"
 
+#include "node/numbernode.h"
+
 OperationCondition::OperationCondition() : m_operator(Modulo), m_boolean(nullptr), m_value(nullptr) {}
 OperationCondition::~OperationCondition()
 {
@@ -93,6 +95,14 @@ void OperationCondition::setOperator(ConditionOperator m)
 void OperationCondition::setValueNode(ExecutionNode* node)
 {
     m_value= node;
+    auto number= dynamic_cast<NumberNode*>(node);
+    m_constant= nullptr != number && number->getNumber() == static_cast<int>(number->getNumber());
+    m_constantValue= m_constant ? number->getNumber() : 0;
+}
+
+ExecutionNode* OperationCondition::getValueNode() const
+{
+    return m_value;
 }
 
 QString OperationCondition::toString()
@@ -126,9 +136,15 @@ Dice::CONDITION_STATE OperationCondition::isValidRangeSize(const std::pair<qint6
     return valid;
 }
 
+bool OperationCondition::dependsOnRollsOnly() const
+{
+    return m_constant && nullptr != m_boolean && m_boolean->dependsOnRollsOnly();
+}
+
 Validator* OperationCondition::getCopy() const
 {
     OperationCondition* val= new OperationCondition();
+    val->setConditionType(m_conditionType);
     val->setOperator(m_operator);
     val->setValueNode(m_value->getCopy());
     BooleanCondition* boolean= dynamic_cast<BooleanCondition*>(m_boolean->getCopy());
@@ -140,6 +156,8 @@ qint64 OperationCondition::valueToScalar() const
 {
     if(m_value == nullptr)
         return 0;
+    if(m_constant)
+        return m_constantValue;
 
     m_value->run(nullptr);
     auto result= m_value->getResult();
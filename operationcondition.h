@@ -41,9 +41,11 @@ public:
     void setOperator(ConditionOperator m);
     // void setValue(qint64);
     void setValueNode(ExecutionNode* node);
+    ExecutionNode* getValueNode() const;
     QString toString() override;
 
     virtual Dice::CONDITION_STATE isValidRangeSize(const std::pair<qint64, qint64>& range) const override;
+    bool dependsOnRollsOnly() const override;
 
     BooleanCondition* getBoolean() const;
     void setBoolean(BooleanCondition* boolean);
@@ -60,6 +62,8 @@ private:
     BooleanCondition* m_boolean= nullptr;
     // qint64 m_value;
     ExecutionNode* m_value= nullptr;
+    bool m_constant= false;
+    qint64 m_constantValue= 0;
 };
 
 #endif // OPERATIONCONDITION_H
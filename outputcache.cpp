@@ -0,0 +1,87 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "outputcache.h"
+
+#include <algorithm>
+
+OutputCache::OutputCache(int capacity) : m_capacity(capacity) {}
+
+int OutputCache::capacity() const
+{
+    return m_capacity;
+}
+
+void OutputCache::setCapacity(int capacity)
+{
+    m_capacity= capacity;
+    while(size() > std::max(m_capacity, 0))
+    {
+        m_index.remove(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+int OutputCache::size() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+void OutputCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+}
+
+QString OutputCache::find(const QString& command, const QString& format)
+{
+    auto it= m_index.find(key(command, format));
+    if(it == m_index.end())
+        return QString();
+
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+    return m_entries.front().second;
+}
+
+void OutputCache::insert(const QString& command, const QString& format, const QString& output)
+{
+    if(m_capacity <= 0)
+        return;
+
+    auto entryKey= key(command, format);
+    auto it= m_index.find(entryKey);
+    if(it != m_index.end())
+    {
+        it.value()->second= output;
+        m_entries.splice(m_entries.begin(), m_entries, it.value());
+        return;
+    }
+
+    m_entries.emplace_front(entryKey, output);
+    m_index.insert(entryKey, m_entries.begin());
+    setCapacity(m_capacity);
+}
+
+QString OutputCache::key(const QString& command, const QString& format)
+{
+    // a format name never holds a line break, a command may.
+    return format + QLatin1Char('\n') + command;
+}
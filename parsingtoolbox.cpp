@@ -26,7 +26,10 @@
 #include <QJsonObject>
 #include <QRegularExpression>
 #include <QString>
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <unordered_set>
 
 #include "node/allsamenode.h"
 #include "node/bind.h"
@@ -57,66 +60,77 @@
 #include "node/uniquenode.h"
 #include "node/valueslistnode.h"
 #include "node/variablenode.h"
+#include "randomengine.h"
 
 QHash<QString, QString> ParsingToolBox::m_variableHash;
+static std::atomic<quint64> s_variableHashGeneration(0);
 
-ParsingToolBox::ParsingToolBox()
-{
-    // m_logicOp = ;
-    m_logicOp.insert(">=", BooleanCondition::GreaterOrEqual);
-    m_logicOp.insert("<=", BooleanCondition::LesserOrEqual);
-    m_logicOp.insert("<", BooleanCondition::LesserThan);
-    m_logicOp.insert("=", BooleanCondition::Equal);
-    m_logicOp.insert(">", BooleanCondition::GreaterThan);
-    m_logicOp.insert("!=", BooleanCondition::Different);
-
-    // m_logicOperation = ;
-    m_logicOperation.insert("|", ValidatorList::OR);
-    m_logicOperation.insert("^", ValidatorList::EXCLUSIVE_OR);
-    m_logicOperation.insert("&", ValidatorList::AND);
-
-    // m_conditionOperation = ;
-    m_conditionOperation.insert("%", OperationCondition::Modulo);
-
-    // m_arithmeticOperation = new QHash<QString,ScalarOperatorNode::ArithmeticOperator>();
-    m_arithmeticOperation.push_back({QStringLiteral("**"), Die::POW});
-    m_arithmeticOperation.push_back({QStringLiteral("+"), Die::PLUS});
-    m_arithmeticOperation.push_back({QStringLiteral("-"), Die::MINUS});
-    m_arithmeticOperation.push_back({QStringLiteral("*"), Die::MULTIPLICATION});
-    m_arithmeticOperation.push_back({QStringLiteral("x"), Die::MULTIPLICATION});
-    m_arithmeticOperation.push_back({QStringLiteral("|"), Die::INTEGER_DIVIDE});
-    m_arithmeticOperation.push_back({QStringLiteral("/"), Die::DIVIDE});
-    m_arithmeticOperation.push_back({QStringLiteral("÷"), Die::DIVIDE});
-
-    m_mapDiceOp.insert(QStringLiteral("D"), D);
-    m_mapDiceOp.insert(QStringLiteral("L"), L);
-
-    m_OptionOp.insert(QStringLiteral("k"), Keep);
-    m_OptionOp.insert(QStringLiteral("K"), KeepAndExplode);
-    m_OptionOp.insert(QStringLiteral("s"), Sort);
-    m_OptionOp.insert(QStringLiteral("c"), Count);
-    m_OptionOp.insert(QStringLiteral("r"), Reroll);
-    m_OptionOp.insert(QStringLiteral("e"), Explode);
-    m_OptionOp.insert(QStringLiteral("R"), RerollUntil);
-    m_OptionOp.insert(QStringLiteral("a"), RerollAndAdd);
-    m_OptionOp.insert(QStringLiteral("m"), Merge);
-    m_OptionOp.insert(QStringLiteral("i"), ifOperator);
-    m_OptionOp.insert(QStringLiteral("p"), Painter);
-    m_OptionOp.insert(QStringLiteral("f"), Filter);
-    m_OptionOp.insert(QStringLiteral("y"), Split);
-    m_OptionOp.insert(QStringLiteral("u"), Unique);
-    m_OptionOp.insert(QStringLiteral("t"), AllSameExplode);
-    m_OptionOp.insert(QStringLiteral("g"), Group);
-    m_OptionOp.insert(QStringLiteral("b"), Bind);
-    m_OptionOp.insert(QStringLiteral("o"), Occurences);
-
-    m_functionMap.insert({QStringLiteral("repeat"), REPEAT});
-
-    m_nodeActionMap.insert(QStringLiteral("@"), JumpBackward);
-
-    m_commandList.append(QStringLiteral("help"));
-    m_commandList.append(QStringLiteral("la"));
+namespace
+{
+template <typename T>
+struct SymbolEntry
+{
+    const char* symbol;
+    T value;
+};
+
+// Operator tables are constant data: nothing is allocated when a ParsingToolBox is built.
+constexpr SymbolEntry<BooleanCondition::LogicOperator> logicOperators[]= {
+    {">=", BooleanCondition::GreaterOrEqual}, {"<=", BooleanCondition::LesserOrEqual},
+    {"<", BooleanCondition::LesserThan},      {"=", BooleanCondition::Equal},
+    {">", BooleanCondition::GreaterThan},     {"!=", BooleanCondition::Different}};
+
+constexpr SymbolEntry<ValidatorList::LogicOperation> logicOperations[]= {
+    {"|", ValidatorList::OR}, {"^", ValidatorList::EXCLUSIVE_OR}, {"&", ValidatorList::AND}};
+
+constexpr SymbolEntry<OperationCondition::ConditionOperator> conditionOperations[]= {
+    {"%", OperationCondition::Modulo}};
+
+// "\xF7" is the latin-1 division sign.
+constexpr SymbolEntry<Die::ArithmeticOperator> arithmeticOperations[]= {
+    {"**", Die::POW},           {"+", Die::PLUS},           {"-", Die::MINUS},  {"*", Die::MULTIPLICATION},
+    {"x", Die::MULTIPLICATION}, {"|", Die::INTEGER_DIVIDE}, {"/", Die::DIVIDE}, {"\xF7", Die::DIVIDE}};
+
+constexpr SymbolEntry<ParsingToolBox::DiceOperator> diceOperators[]= {{"D", ParsingToolBox::D},
+                                                                        {"L", ParsingToolBox::L}};
+
+constexpr SymbolEntry<ParsingToolBox::OptionOperator> optionOperators[]= {
+    {"k", ParsingToolBox::Keep},         {"K", ParsingToolBox::KeepAndExplode},
+    {"s", ParsingToolBox::Sort},         {"c", ParsingToolBox::Count},
+    {"r", ParsingToolBox::Reroll},       {"e", ParsingToolBox::Explode},
+    {"R", ParsingToolBox::RerollUntil},  {"a", ParsingToolBox::RerollAndAdd},
+    {"m", ParsingToolBox::Merge},        {"i", ParsingToolBox::ifOperator},
+    {"p", ParsingToolBox::Painter},      {"f", ParsingToolBox::Filter},
+    {"y", ParsingToolBox::Split},        {"u", ParsingToolBox::Unique},
+    {"t", ParsingToolBox::AllSameExplode}, {"g", ParsingToolBox::Group},
+    {"b", ParsingToolBox::Bind},         {"o", ParsingToolBox::Occurences}};
+
+constexpr SymbolEntry<ParsingToolBox::Function> functions[]= {{"repeat", ParsingToolBox::REPEAT}};
+
+constexpr SymbolEntry<ParsingToolBox::NodeAction> nodeActions[]= {{"@", ParsingToolBox::JumpBackward}};
+
+constexpr const char* commands[]= {"help", "la"};
+
+template <typename T, std::size_t N>
+const SymbolEntry<T>* findLongestPrefix(const QString& str, const SymbolEntry<T> (&table)[N],
+                                         Qt::CaseSensitivity cs= Qt::CaseSensitive)
+{
+    const SymbolEntry<T>* result= nullptr;
+    int length= 0;
+    for(const auto& entry : table)
+    {
+        QLatin1String symbol(entry.symbol);
+        if(symbol.size() > length && str.startsWith(symbol, cs))
+        {
+            result= &entry;
+            length= symbol.size();
+        }
+    }
+    return result;
 }
+} // namespace
+
+ParsingToolBox::ParsingToolBox() {}
 
 ParsingToolBox::ParsingToolBox(const ParsingToolBox&) {}
 ParsingToolBox::~ParsingToolBox() {}
@@ -124,6 +138,7 @@ ParsingToolBox::~ParsingToolBox() {}
 void ParsingToolBox::clearUp()
 {
     m_errorMap.clear();
+    m_warningMap.clear();
     m_comment= QString("");
 }
 
@@ -148,6 +163,43 @@ ExecutionNode* ParsingToolBox::getLeafNode(ExecutionNode* start)
     }
     return next;
 }
+bool ParsingToolBox::isPure(const std::vector<ExecutionNode*>& instructions)
+{
+    std::vector<ExecutionNode*> pending(instructions.begin(), instructions.end());
+    std::unordered_set<ExecutionNode*> visited;
+    while(!pending.empty())
+    {
+        auto node= pending.back();
+        pending.pop_back();
+        if(nullptr == node || !visited.insert(node).second)
+            continue;
+
+        // nodes drawing random values: exploding, rerolling and t also roll dice given by a list.
+        if(nullptr != dynamic_cast<DiceRollerNode*>(node) || nullptr != dynamic_cast<ListSetRollNode*>(node)
+           || nullptr != dynamic_cast<ExplodeDiceNode*>(node) || nullptr != dynamic_cast<RerollDiceNode*>(node)
+           || nullptr != dynamic_cast<AllSameNode*>(node))
+            return false;
+
+        if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+            pending.push_back(operation->getInternalNode());
+        else if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+            pending.push_back(parentheses->getInternalNode());
+        else if(auto condition= dynamic_cast<IfNode*>(node))
+        {
+            pending.push_back(condition->getInstructionTrue());
+            pending.push_back(condition->getInstructionFalse());
+        }
+        else if(auto repeater= dynamic_cast<RepeaterNode*>(node))
+        {
+            pending.push_back(repeater->getTimeNode());
+            pending.insert(pending.end(), repeater->getCommand().begin(), repeater->getCommand().end());
+        }
+        else if(auto values= dynamic_cast<ValuesListNode*>(node))
+            pending.insert(pending.end(), values->getValues().begin(), values->getValues().end());
+        pending.push_back(node->getNextNode());
+    }
+    return true;
+}
 void ParsingToolBox::addError(Dice::ERROR_CODE code, const QString& msg)
 {
     m_errorMap.insert(code, msg);
@@ -158,64 +210,35 @@ void ParsingToolBox::addWarning(Dice::ERROR_CODE code, const QString& msg)
 }
 bool ParsingToolBox::readDiceLogicOperator(QString& str, OperationCondition::ConditionOperator& op)
 {
-    QString longKey;
-    auto const& keys= m_conditionOperation.keys();
-    for(const QString& tmp : keys)
-    {
-        if(str.startsWith(tmp))
-        {
-            if(longKey.size() < tmp.size())
-            {
-                longKey= tmp;
-            }
-        }
-    }
-    if(longKey.size() > 0)
-    {
-        str= str.remove(0, longKey.size());
-        op= m_conditionOperation.value(longKey);
-        return true;
-    }
+    auto entry= findLongestPrefix(str, conditionOperations);
+    if(nullptr == entry)
+        return false;
 
-    return false;
+    str= str.remove(0, QLatin1String(entry->symbol).size());
+    op= entry->value;
+    return true;
 }
 
 bool ParsingToolBox::readArithmeticOperator(QString& str, Die::ArithmeticOperator& op)
 {
-
-    auto it= std::find_if(
-        m_arithmeticOperation.begin(), m_arithmeticOperation.end(),
-        [str](const std::pair<QString, Die::ArithmeticOperator>& pair) { return str.startsWith(pair.first); });
-    if(it == m_arithmeticOperation.end())
+    auto entry= findLongestPrefix(str, arithmeticOperations);
+    if(nullptr == entry)
         return false;
 
-    op= it->second;
-    str= str.remove(0, it->first.size());
+    op= entry->value;
+    str= str.remove(0, QLatin1String(entry->symbol).size());
     return true;
 }
 
 bool ParsingToolBox::readLogicOperator(QString& str, BooleanCondition::LogicOperator& op)
 {
-    QString longKey;
-    auto const& keys= m_logicOp.keys();
-    for(const QString& tmp : keys)
-    {
-        if(str.startsWith(tmp))
-        {
-            if(longKey.size() < tmp.size())
-            {
-                longKey= tmp;
-            }
-        }
-    }
-    if(longKey.size() > 0)
-    {
-        str= str.remove(0, longKey.size());
-        op= m_logicOp.value(longKey);
-        return true;
-    }
+    auto entry= findLongestPrefix(str, logicOperators);
+    if(nullptr == entry)
+        return false;
 
-    return false;
+    str= str.remove(0, QLatin1String(entry->symbol).size());
+    op= entry->value;
+    return true;
 }
 QString ParsingToolBox::getComment() const
 {
@@ -401,26 +424,13 @@ ValidatorList* ParsingToolBox::readValidatorList(QString& str)
 }
 bool ParsingToolBox::readLogicOperation(QString& str, ValidatorList::LogicOperation& op)
 {
-    QString longKey;
-    auto const& keys= m_logicOperation.keys();
-    for(auto& tmp : keys)
-    {
-        if(str.startsWith(tmp))
-        {
-            if(longKey.size() < tmp.size())
-            {
-                longKey= tmp;
-            }
-        }
-    }
-    if(longKey.size() > 0)
-    {
-        str= str.remove(0, longKey.size());
-        op= m_logicOperation.value(longKey);
-        return true;
-    }
+    auto entry= findLongestPrefix(str, logicOperations);
+    if(nullptr == entry)
+        return false;
 
-    return false;
+    str= str.remove(0, QLatin1String(entry->symbol).size());
+    op= entry->value;
+    return true;
 }
 
 bool ParsingToolBox::readNumber(QString& str, qint64& myNumber)
@@ -494,6 +504,10 @@ const std::vector<ExecutionNode*>& ParsingToolBox::getStartNodes()
 {
     return m_startNodes;
 }
+std::vector<ExecutionNode*>* ParsingToolBox::getStartNodeList()
+{
+    return &m_startNodes;
+}
 
 QStringList ParsingToolBox::allFirstResultAsString(bool& hasAlias) const
 {
@@ -543,7 +557,7 @@ std::pair<bool, QVariant> ParsingToolBox::hasResultOfType(Dice::RESULT_TYPE type
 QList<qreal> ParsingToolBox::scalarResultsFromEachInstruction() const
 {
     QList<qreal> resultValues;
-    std::set<QString> alreadyVisitedNode;
+    std::unordered_set<quint64> alreadyVisitedNode;
     for(auto node : m_startNodes)
     {
         ExecutionNode* next= ParsingToolBox::getLeafNode(node);
@@ -579,12 +593,12 @@ QList<qreal> ParsingToolBox::sumOfDiceResult() const
         {
             if(result->hasResultOfType(Dice::RESULT_TYPE::DICE_LIST))
             {
-                DiceResult* myDiceResult= dynamic_cast<DiceResult*>(result);
+                DiceResult* myDiceResult= Result::asDice(result);
                 if(nullptr != myDiceResult)
                 {
-                    for(auto& die : myDiceResult->getResultList())
+                    for(const auto& die : myDiceResult->view())
                     {
-                        resultValue+= die->getValue();
+                        resultValue+= die.getValue();
                     }
                     found= true;
                 }
@@ -667,7 +681,7 @@ QList<ExportedDiceResult> ParsingToolBox::diceResultFromEachInstruction() const
 QStringList listOfDiceResult(const QList<ExportedDiceResult>& list, bool removeDouble= false)
 {
     QStringList listOfDiceResult;
-    std::set<QString> alreadyAdded;
+    std::unordered_set<quint64> alreadyAdded;
     for(auto map : list)
     {
         for(auto key : map.keys())
@@ -678,11 +692,9 @@ QStringList listOfDiceResult(const QList<ExportedDiceResult>& list, bool removeD
                 QString stringVal;
                 for(auto val : dice)
                 {
-                    if(removeDouble && (alreadyAdded.end() != alreadyAdded.find(val.uuid())))
+                    if(!alreadyAdded.insert(val.uuid()).second && removeDouble)
                         continue;
 
-                    alreadyAdded.insert(val.uuid());
-
                     qint64 total= 0;
                     QStringList dicelist;
                     for(auto score : val.result())
@@ -1005,6 +1017,12 @@ QHash<QString, QString> ParsingToolBox::getVariableHash()
 void ParsingToolBox::setVariableHash(const QHash<QString, QString>& variableHash)
 {
     m_variableHash= variableHash;
+    ++s_variableHashGeneration;
+}
+
+quint64 ParsingToolBox::variableHashGeneration()
+{
+    return s_variableHashGeneration;
 }
 
 void ParsingToolBox::setStartNodes(std::vector<ExecutionNode*> nodes)
@@ -1530,6 +1548,24 @@ void ParsingToolBox::setHelpPath(const QString& path)
     m_helpPath= path;
 }
 
+std::shared_ptr<RandomEngine> ParsingToolBox::getRandomEngine() const
+{
+    return m_randomEngine;
+}
+
+void ParsingToolBox::setRandomEngine(const std::shared_ptr<RandomEngine>& engine)
+{
+    m_randomEngine= engine;
+}
+
+std::shared_ptr<RandomEngine> ParsingToolBox::nodeRandomEngine()
+{
+    if(!m_randomEngine)
+        return m_randomEngine;
+    std::shared_ptr<RandomEngine> stream(m_randomEngine->createStream(m_instructionIndex, m_rollingNodeIndex++));
+    return stream ? stream : m_randomEngine;
+}
+
 bool ParsingToolBox::readOperatorFromNull(QString& str, ExecutionNode*& node)
 {
     StartingNode nodePrevious;
@@ -1552,15 +1588,14 @@ bool ParsingToolBox::readOption(QString& str, ExecutionNode* previous) //,
 
     ExecutionNode* node= nullptr;
     bool found= false;
-    auto keys= m_OptionOp.keys();
-    for(int i= 0; ((i < keys.size()) && (!found)); ++i)
+    for(auto it= std::begin(optionOperators); ((it != std::end(optionOperators)) && (!found)); ++it)
     {
-        QString key= keys.at(i);
+        QLatin1String key(it->symbol);
 
         if(str.startsWith(key))
         {
             str= str.remove(0, key.size());
-            auto operatorName= m_OptionOp.value(key);
+            auto operatorName= it->value;
             switch(operatorName)
             {
             case Keep:
@@ -1661,7 +1696,7 @@ bool ParsingToolBox::readOption(QString& str, ExecutionNode* previous) //,
                 // Todo: I think that Exploding and Rerolling could share the same code
                 {
                     auto validatorList= readValidatorList(str);
-                    QString symbol= m_OptionOp.key(operatorName);
+                    QString symbol= key;
                     if(nullptr != validatorList)
                     {
                         switch(isValidValidator(previous, validatorList))
@@ -1693,6 +1728,7 @@ bool ParsingToolBox::readOption(QString& str, ExecutionNode* previous) //,
                         auto reroll= (operatorName == RerollAndAdd || operatorName == Reroll);
                         auto addingMode= (operatorName == RerollAndAdd);
                         RerollDiceNode* rerollNode= new RerollDiceNode(reroll, addingMode);
+                        rerollNode->setRandomEngine(nodeRandomEngine());
                         ExecutionNode* nodeParam= nullptr;
                         if(readParameterNode(str, nodeParam))
                         {
@@ -1723,6 +1759,7 @@ bool ParsingToolBox::readOption(QString& str, ExecutionNode* previous) //,
                                               .arg(validatorList->toString()));
                     }
                     ExplodeDiceNode* explodedNode= new ExplodeDiceNode();
+                    explodedNode->setRandomEngine(nodeRandomEngine());
                     explodedNode->setValidatorList(validatorList);
                     previous->setNextNode(explodedNode);
                     node= explodedNode;
@@ -1747,6 +1784,7 @@ bool ParsingToolBox::readOption(QString& str, ExecutionNode* previous) //,
             case AllSameExplode:
             {
                 AllSameNode* allSame= new AllSameNode();
+                allSame->setRandomEngine(nodeRandomEngine());
                 previous->setNextNode(allSame);
                 node= allSame;
                 found= true;
@@ -1890,12 +1928,14 @@ bool ParsingToolBox::readIfInstruction(QString& str, ExecutionNode*& trueNode, E
 DiceRollerNode* ParsingToolBox::addRollDiceNode(qint64 faces, ExecutionNode* previous)
 {
     DiceRollerNode* mydiceRoller= new DiceRollerNode(faces);
+    mydiceRoller->setRandomEngine(nodeRandomEngine());
     previous->setNextNode(mydiceRoller);
     return mydiceRoller;
 }
 ExplodeDiceNode* ParsingToolBox::addExplodeDiceNode(qint64 value, ExecutionNode* previous)
 {
     ExplodeDiceNode* explodeDiceNode= new ExplodeDiceNode();
+    explodeDiceNode->setRandomEngine(nodeRandomEngine());
     NumberNode* node= new NumberNode();
     node->setNumber(value);
     BooleanCondition* condition= new BooleanCondition();
@@ -1984,6 +2024,7 @@ bool ParsingToolBox::readDice(QString& str, ExecutionNode*& node)
                 }
                 DiceRollerNode* drNode= new DiceRollerNode(max);
                 drNode->setUnique(unique);
+                drNode->setRandomEngine(nodeRandomEngine());
                 if(hasOp)
                 {
                     drNode->setOperator(op);
@@ -2000,6 +2041,7 @@ bool ParsingToolBox::readDice(QString& str, ExecutionNode*& node)
             {
                 DiceRollerNode* drNode= new DiceRollerNode(max, min);
                 drNode->setUnique(unique);
+                drNode->setRandomEngine(nodeRandomEngine());
                 if(hasOp)
                 {
                     drNode->setOperator(op);
@@ -2021,6 +2063,7 @@ bool ParsingToolBox::readDice(QString& str, ExecutionNode*& node)
             if(readList(str, list, listRange))
             {
                 ListSetRollNode* lsrNode= new ListSetRollNode();
+                lsrNode->setRandomEngine(nodeRandomEngine());
                 lsrNode->setRangeList(listRange);
                 if(op == ParsingToolBox::UNIQUE)
                 {
@@ -2044,17 +2087,13 @@ bool ParsingToolBox::readDice(QString& str, ExecutionNode*& node)
 }
 bool ParsingToolBox::readDiceOperator(QString& str, DiceOperator& op)
 {
-    QStringList listKey= m_mapDiceOp.keys();
-    for(const QString& key : listKey)
-    {
-        if(str.startsWith(key, Qt::CaseInsensitive))
-        {
-            str= str.remove(0, key.size());
-            op= m_mapDiceOp.value(key);
-            return true;
-        }
-    }
-    return false;
+    auto entry= findLongestPrefix(str, diceOperators, Qt::CaseInsensitive);
+    if(nullptr == entry)
+        return false;
+
+    str= str.remove(0, QLatin1String(entry->symbol).size());
+    op= entry->value;
+    return true;
 }
 QString ParsingToolBox::convertAlias(QString str)
 {
@@ -2070,7 +2109,8 @@ QString ParsingToolBox::convertAlias(QString str)
 
 bool ParsingToolBox::readCommand(QString& str, ExecutionNode*& node)
 {
-    if(m_commandList.contains(str))
+    if(std::any_of(std::begin(commands), std::end(commands),
+                   [&str](const char* command) { return str == QLatin1String(command); }))
     {
         if(str == QLatin1String("help"))
         {
@@ -2184,12 +2224,13 @@ bool ParsingToolBox::readOperator(QString& str, ExecutionNode* previous)
 }
 bool ParsingToolBox::readFunction(QString& str, ExecutionNode*& node)
 {
-    for(const auto& kv : m_functionMap)
+    for(const auto& kv : functions)
     {
-        if(str.startsWith(kv.first))
+        QLatin1String name(kv.symbol);
+        if(str.startsWith(name))
         {
-            str= str.remove(0, kv.first.size());
-            switch(kv.second)
+            str= str.remove(0, name.size());
+            switch(kv.value)
             {
             case REPEAT:
             {
@@ -2214,8 +2255,7 @@ bool ParsingToolBox::readNode(QString& str, ExecutionNode*& node)
     if(str.isEmpty())
         return false;
 
-    QString key= str.at(0);
-    if(m_nodeActionMap.contains(key))
+    if(nullptr != findLongestPrefix(str, nodeActions))
     {
         JumpBackwardNode* jumpNode= new JumpBackwardNode();
         node= jumpNode;
@@ -2263,6 +2303,11 @@ std::vector<ExecutionNode*> ParsingToolBox::readInstructionList(QString& str, bo
     bool readInstruction= true;
     while(readInstruction)
     {
+        if(global)
+        {
+            m_instructionIndex= static_cast<quint32>(startNodes.size());
+            m_rollingNodeIndex= 0;
+        }
         ExecutionNode* startNode= nullptr;
         bool keepParsing= readExpression(str, startNode);
         if(nullptr != startNode)
@@ -2374,23 +2419,21 @@ ExportedDiceResult ParsingToolBox::finalDiceResultFromInstruction(ExecutionNode*
     ExecutionNode* next= ParsingToolBox::getLeafNode(start);
     Result* result= next->getResult();
     ExportedDiceResult nodeResult;
-    std::set<QString> alreadyAdded;
+    std::unordered_set<quint64> alreadyAdded;
     while(nullptr != result)
     {
         if(result->hasResultOfType(Dice::RESULT_TYPE::DICE_LIST))
         {
-            DiceResult* diceResult= dynamic_cast<DiceResult*>(result);
+            DiceResult* diceResult= Result::asDice(result);
             QList<HighLightDice> list;
             quint64 faces= 0;
-            for(auto& die : diceResult->getResultList())
+            for(const auto& die : diceResult->view())
             {
-                faces= die->getFaces();
-                HighLightDice hlDice(die->getListValue(), die->isHighlighted(), die->getColor(),
-                                     die->hasBeenDisplayed(), die->getFaces(), die->getUuid());
-                if(alreadyAdded.find(die->getUuid()) == alreadyAdded.end() && !hlDice.displayed())
+                faces= die.getFaces();
+                if(!die.hasBeenDisplayed() && alreadyAdded.insert(die.getUuid()).second)
                 {
-                    list.append(hlDice);
-                    alreadyAdded.insert(die->getUuid());
+                    list.append(HighLightDice(die.getListValue(), die.isHighlighted(), die.getColor(),
+                                              die.hasBeenDisplayed(), faces, die.getUuid()));
                 }
             }
             if(!list.isEmpty())
@@ -2413,23 +2456,21 @@ ExportedDiceResult ParsingToolBox::allDiceResultFromInstruction(ExecutionNode* s
     ExecutionNode* next= ParsingToolBox::getLeafNode(start);
     Result* result= next->getResult();
     ExportedDiceResult nodeResult;
-    std::set<QString> alreadyAdded;
+    std::unordered_set<quint64> alreadyAdded;
     while(nullptr != result)
     {
         if(result->hasResultOfType(Dice::RESULT_TYPE::DICE_LIST))
         {
-            DiceResult* diceResult= dynamic_cast<DiceResult*>(result);
+            DiceResult* diceResult= Result::asDice(result);
             QList<HighLightDice> list;
             quint64 faces= 0;
-            for(auto& die : diceResult->getResultList())
+            for(const auto& die : diceResult->view())
             {
-                faces= die->getFaces();
-                HighLightDice hlDice(die->getListValue(), die->isHighlighted(), die->getColor(),
-                                     die->hasBeenDisplayed(), die->getFaces(), die->getUuid());
-                if(alreadyAdded.find(die->getUuid()) == alreadyAdded.end())
+                faces= die.getFaces();
+                if(alreadyAdded.insert(die.getUuid()).second)
                 {
-                    list.append(hlDice);
-                    alreadyAdded.insert(die->getUuid());
+                    list.append(HighLightDice(die.getListValue(), die.isHighlighted(), die.getColor(),
+                                              die.hasBeenDisplayed(), faces, die.getUuid()));
                 }
             }
             if(!list.isEmpty())
@@ -2470,7 +2511,7 @@ void ParsingToolBox::addDiceResultInJson(
                 diceObj["displayed"]= hlDice.displayed();
                 diceObj["string"]= colorize(hlDice.getResultString(), hlDice.color(), hlDice.isHighlighted());
                 diceObj["highlight"]= hlDice.isHighlighted();
-                diceObj["uuid"]= hlDice.uuid();
+                diceObj["uuid"]= QString::number(hlDice.uuid());
                 auto val= hlDice.result();
                 if(!val.isEmpty())
                 {
@@ -0,0 +1,308 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "preparedcommand.h"
+
+#include <algorithm>
+#include <typeinfo>
+#include <unordered_set>
+
+#include "booleancondition.h"
+#include "node/countexecutenode.h"
+#include "node/executionnode.h"
+#include "node/explodedicenode.h"
+#include "node/filternode.h"
+#include "node/ifnode.h"
+#include "node/occurencecountnode.h"
+#include "node/parenthesesnode.h"
+#include "node/repeaternode.h"
+#include "node/rerolldicenode.h"
+#include "node/scalaroperatornode.h"
+#include "node/valueslistnode.h"
+#include "operationcondition.h"
+#include "validatorlist.h"
+
+namespace
+{
+void pushOperands(const ValidatorList* validators, std::vector<ExecutionNode*>& pending)
+{
+    if(nullptr == validators)
+        return;
+    for(auto validator : validators->getValidators())
+    {
+        if(auto boolean= dynamic_cast<BooleanCondition*>(validator))
+        {
+            pending.push_back(boolean->getValueNode());
+        }
+        else if(auto operation= dynamic_cast<OperationCondition*>(validator))
+        {
+            pending.push_back(operation->getValueNode());
+            if(nullptr != operation->getBoolean())
+                pending.push_back(operation->getBoolean()->getValueNode());
+        }
+    }
+}
+
+/**
+ * @brief shapeOf
+ * @return type of every node reached from instructions, internal nodes and validator operands included, in walking
+ * order. A copy which has lost a node does not have the shape of its source.
+ */
+std::vector<const std::type_info*> shapeOf(const std::vector<ExecutionNode*>& instructions)
+{
+    std::vector<const std::type_info*> shape;
+    std::vector<ExecutionNode*> pending(instructions.rbegin(), instructions.rend());
+    std::unordered_set<ExecutionNode*> visited;
+    while(!pending.empty())
+    {
+        auto node= pending.back();
+        pending.pop_back();
+        if(nullptr == node)
+        {
+            shape.push_back(nullptr);
+            continue;
+        }
+        shape.push_back(&typeid(*node));
+        if(!visited.insert(node).second)
+            continue;
+
+        pending.push_back(node->getNextNode());
+        if(auto operation= dynamic_cast<ScalarOperatorNode*>(node))
+        {
+            pending.push_back(operation->getInternalNode());
+        }
+        else if(auto parentheses= dynamic_cast<ParenthesesNode*>(node))
+        {
+            pending.push_back(parentheses->getInternalNode());
+        }
+        else if(auto condition= dynamic_cast<IfNode*>(node))
+        {
+            pending.push_back(condition->getInstructionTrue());
+            pending.push_back(condition->getInstructionFalse());
+            pushOperands(condition->getValidatorList(), pending);
+        }
+        else if(auto repeater= dynamic_cast<RepeaterNode*>(node))
+        {
+            pending.push_back(repeater->getTimeNode());
+            pending.insert(pending.end(), repeater->getCommand().begin(), repeater->getCommand().end());
+        }
+        else if(auto values= dynamic_cast<ValuesListNode*>(node))
+        {
+            pending.insert(pending.end(), values->getValues().begin(), values->getValues().end());
+        }
+        else if(auto reroll= dynamic_cast<RerollDiceNode*>(node))
+        {
+            pending.push_back(reroll->getInstruction());
+            pushOperands(reroll->getValidatorList(), pending);
+        }
+        else if(auto explode= dynamic_cast<ExplodeDiceNode*>(node))
+        {
+            pushOperands(explode->getValidatorList(), pending);
+        }
+        else if(auto count= dynamic_cast<CountExecuteNode*>(node))
+        {
+            pushOperands(count->getValidatorList(), pending);
+        }
+        else if(auto filter= dynamic_cast<FilterNode*>(node))
+        {
+            pushOperands(filter->getValidatorList(), pending);
+        }
+        else if(auto occurence= dynamic_cast<OccurenceCountNode*>(node))
+        {
+            pushOperands(occurence->getValidatorList(), pending);
+        }
+    }
+    return shape;
+}
+} // namespace
+
+struct PreparedCommand::Plan
+{
+    ~Plan()
+    {
+        for(auto node : nodes)
+            delete node;
+    }
+
+    QString command;
+    QString comment;
+    QMap<Dice::ERROR_CODE, QString> errors;
+    QMap<Dice::ERROR_CODE, QString> warnings;
+    std::vector<ExecutionNode*> nodes;
+};
+
+PreparedCommand::PreparedCommand() {}
+
+PreparedCommand PreparedCommand::build(const QString& command, const QString& comment,
+                                       const QMap<Dice::ERROR_CODE, QString>& errors,
+                                       const QMap<Dice::ERROR_CODE, QString>& warnings,
+                                       const std::vector<ExecutionNode*>& parsed)
+{
+    auto plan= std::make_shared<Plan>();
+    plan->command= command;
+    plan->comment= comment;
+    plan->errors= errors;
+    plan->warnings= warnings;
+    plan->nodes.reserve(parsed.size());
+    ExecutionNode::redirectStartList(&parsed, &plan->nodes);
+    for(auto node : parsed)
+        plan->nodes.push_back(node->getCopy());
+    ExecutionNode::redirectStartList(nullptr, nullptr);
+
+    // a node left out of its copy would make every run differ from the parsed command: no plan then.
+    if(shapeOf(parsed) != shapeOf(plan->nodes))
+    {
+        for(auto node : plan->nodes)
+            delete node;
+        plan->nodes.clear();
+    }
+
+    PreparedCommand prepared;
+    prepared.m_plan= plan;
+    return prepared;
+}
+
+bool PreparedCommand::isValid() const
+{
+    return m_plan && !m_plan->nodes.empty() && m_plan->errors.isEmpty();
+}
+
+QString PreparedCommand::command() const
+{
+    return m_plan ? m_plan->command : QString();
+}
+
+QString PreparedCommand::comment() const
+{
+    return m_plan ? m_plan->comment : QString();
+}
+
+int PreparedCommand::instructionCount() const
+{
+    return m_plan ? static_cast<int>(m_plan->nodes.size()) : 0;
+}
+
+const QMap<Dice::ERROR_CODE, QString>& PreparedCommand::errorMap() const
+{
+    static const QMap<Dice::ERROR_CODE, QString> empty;
+    return m_plan ? m_plan->errors : empty;
+}
+
+const QMap<Dice::ERROR_CODE, QString>& PreparedCommand::warningMap() const
+{
+    static const QMap<Dice::ERROR_CODE, QString> empty;
+    return m_plan ? m_plan->warnings : empty;
+}
+
+void PreparedCommand::instantiate(std::vector<ExecutionNode*>& startNodes) const
+{
+    startNodes.clear();
+    if(!m_plan)
+        return;
+
+    startNodes.reserve(m_plan->nodes.size());
+    ExecutionNode::redirectStartList(&m_plan->nodes, &startNodes);
+    for(auto node : m_plan->nodes)
+        startNodes.push_back(node->getCopy());
+    ExecutionNode::redirectStartList(nullptr, nullptr);
+}
+
+PreparedCommandCache::PreparedCommandCache(int capacity) : m_capacity(capacity) {}
+
+int PreparedCommandCache::capacity() const
+{
+    return m_capacity;
+}
+
+void PreparedCommandCache::setCapacity(int capacity)
+{
+    m_capacity= capacity;
+    while(size() > std::max(m_capacity, 0))
+    {
+        m_index.remove(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+int PreparedCommandCache::size() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+void PreparedCommandCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+}
+
+PreparedCommand PreparedCommandCache::find(const QString& key)
+{
+    auto it= m_index.find(key);
+    if(it == m_index.end())
+        return PreparedCommand();
+
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+    return m_entries.front().second;
+}
+
+void PreparedCommandCache::insert(const QString& key, const PreparedCommand& command)
+{
+    if(m_capacity <= 0)
+        return;
+
+    auto it= m_index.find(key);
+    if(it != m_index.end())
+    {
+        it.value()->second= command;
+        m_entries.splice(m_entries.begin(), m_entries, it.value());
+        return;
+    }
+
+    m_entries.emplace_front(key, command);
+    m_index.insert(key, m_entries.begin());
+    setCapacity(m_capacity);
+}
+
+QString PreparedCommandCache::normalize(const QString& command)
+{
+    QString key= command;
+    int depth= 0;
+    bool inString= false;
+    for(int i= 0; i < key.size(); ++i)
+    {
+        auto c= key.at(i);
+        if(c == '"')
+            inString= !inString;
+        else if(inString)
+            continue;
+        else if(c == '[' || c == '{')
+            ++depth;
+        else if((c == ']' || c == '}') && depth > 0)
+            --depth;
+        else if(depth > 0)
+            continue;
+        else if(c == '#')
+            break;
+        else if(c == 'D')
+            key[i]= QChar('d');
+    }
+    return key;
+}
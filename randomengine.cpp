@@ -0,0 +1,556 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "randomengine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace
+{
+quint64 splitMix64(quint64& state)
+{
+    quint64 z= (state+= 0x9E3779B97F4A7C15ull);
+    z= (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z= (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+quint64 rotl(quint64 x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// full 128-bit product of a and b, the high half is returned and the low half stored in low.
+quint64 mul128(quint64 a, quint64 b, quint64& low)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 quint128;
+    quint128 product= static_cast<quint128>(a) * b;
+    low= static_cast<quint64>(product);
+    return static_cast<quint64>(product >> 64);
+#else
+    const quint64 aLo= a & 0xFFFFFFFFull;
+    const quint64 aHi= a >> 32;
+    const quint64 bLo= b & 0xFFFFFFFFull;
+    const quint64 bHi= b >> 32;
+    const quint64 loLo= aLo * bLo;
+    const quint64 hiLo= aHi * bLo;
+    const quint64 loHi= aLo * bHi;
+    const quint64 cross= (loLo >> 32) + (hiLo & 0xFFFFFFFFull) + loHi;
+    low= (cross << 32) | (loLo & 0xFFFFFFFFull);
+    return aHi * bHi + (hiLo >> 32) + (cross >> 32);
+#endif
+}
+
+// uniform value in (0, 1): never 0, so its logarithm is always defined.
+double openUnit(RandomEngine& engine)
+{
+    return (static_cast<double>(engine.next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// log(k!) minus its Stirling approximation.
+double stirlingTail(double k)
+{
+    static const double tails[]= {0.0810614667953272,  0.0413406959554092,  0.0276779256849983, 0.02079067210376509,
+                                  0.0166446911898211,  0.0138761288230707,  0.0118967099458917, 0.0104112652619720,
+                                  0.00925546218271273, 0.00833056343336287};
+    if(k <= 9)
+        return tails[static_cast<int>(k)];
+    const double square= (k + 1) * (k + 1);
+    return (1.0 / 12 - (1.0 / 360 - 1.0 / 1260 / square) / square) / (k + 1);
+}
+
+// sums geometric waiting times until they pass n: expected cost n * p draws.
+qint64 binomialInversion(RandomEngine& engine, qint64 n, double p)
+{
+    const double logQ= std::log1p(-p);
+    double sum= 0;
+    qint64 successes= 0;
+    while(true)
+    {
+        sum+= std::ceil(std::log(openUnit(engine)) / logQ);
+        if(sum > static_cast<double>(n))
+            return successes;
+        ++successes;
+    }
+}
+
+// transformed rejection with squeeze, for n * p >= 10 and p <= 0.5.
+qint64 binomialRejection(RandomEngine& engine, qint64 trials, double p)
+{
+    const double n= static_cast<double>(trials);
+    const double deviation= std::sqrt(n * p * (1 - p));
+    const double b= 1.15 + 2.53 * deviation;
+    const double a= -0.0873 + 0.0248 * b + 0.01 * p;
+    const double c= n * p + 0.5;
+    const double vr= 0.92 - 4.2 / b;
+    const double r= p / (1 - p);
+    const double alpha= (2.83 + 5.1 / b) * deviation;
+    const double m= std::floor((n + 1) * p);
+    while(true)
+    {
+        const double u= openUnit(engine) - 0.5;
+        double v= openUnit(engine);
+        const double us= 0.5 - std::abs(u);
+        const double k= std::floor((2 * a / us + b) * u + c);
+        if(us >= 0.07 && v <= vr)
+            return static_cast<qint64>(k);
+        if(k < 0 || k > n)
+            continue;
+        v= std::log(v * alpha / (a / (us * us) + b));
+        const double bound= (m + 0.5) * std::log((m + 1) / (r * (n - m + 1)))
+                            + (n + 1) * std::log((n - m + 1) / (n - k + 1))
+                            + (k + 0.5) * std::log(r * (n - k + 1) / (k + 1)) + stirlingTail(m)
+                            + stirlingTail(n - m) - stirlingTail(k) - stirlingTail(n - k);
+        if(v <= bound)
+            return static_cast<qint64>(k);
+    }
+}
+} // namespace
+
+RandomEngine::~RandomEngine() {}
+
+qint64 RandomEngine::bounded(qint64 base, qint64 max)
+{
+    qint64 value;
+    fillBounded(base, max, &value, 1);
+    return value;
+}
+
+void RandomEngine::fillBounded(qint64 base, qint64 max, qint64* out, std::size_t count)
+{
+    if(max < base)
+        std::swap(base, max);
+
+    const quint64 offset= static_cast<quint64>(base);
+    const quint64 range= static_cast<quint64>(max) - offset;
+    if(range == std::numeric_limits<quint64>::max())
+    {
+        for(std::size_t i= 0; i < count; ++i)
+            out[i]= static_cast<qint64>(next());
+        return;
+    }
+
+    if(range <= std::numeric_limits<quint32>::max())
+    {
+        // small ranges (all real dice): each 64-bit word feeds two 32-bit draws.
+        const quint32 span= static_cast<quint32>(range) + 1u;
+        if(span == 0u)
+        {
+            for(std::size_t i= 0; i < count; i+= 2)
+            {
+                const quint64 bits= next();
+                out[i]= static_cast<qint64>(offset + (bits & 0xFFFFFFFFull));
+                if(i + 1 < count)
+                    out[i + 1]= static_cast<qint64>(offset + (bits >> 32));
+            }
+            return;
+        }
+        const quint32 threshold= static_cast<quint32>(0u - span) % span;
+        quint64 bits= 0;
+        int lanes= 0;
+        for(std::size_t i= 0; i < count; ++i)
+        {
+            quint64 product;
+            do
+            {
+                if(lanes == 0)
+                {
+                    bits= next();
+                    lanes= 2;
+                }
+                product= (bits & 0xFFFFFFFFull) * span;
+                bits>>= 32;
+                --lanes;
+            } while(static_cast<quint32>(product) < threshold);
+            out[i]= static_cast<qint64>(offset + (product >> 32));
+        }
+        return;
+    }
+
+    const quint64 span= range + 1;
+    const quint64 threshold= (0 - span) % span;
+    for(std::size_t i= 0; i < count; ++i)
+    {
+        quint64 low;
+        quint64 high;
+        do
+        {
+            high= mul128(next(), span, low);
+        } while(low < threshold);
+        out[i]= static_cast<qint64>(offset + high);
+    }
+}
+
+qint64 RandomEngine::binomial(qint64 trials, double p)
+{
+    if(trials <= 0 || p <= 0)
+        return 0;
+    if(p >= 1)
+        return trials;
+    // both methods expect the rarer outcome.
+    const bool flipped= p > 0.5;
+    const double q= flipped ? 1 - p : p;
+    const qint64 successes= static_cast<double>(trials) * q >= 10 ? binomialRejection(*this, trials, q) :
+                                                                     binomialInversion(*this, trials, q);
+    return flipped ? trials - successes : successes;
+}
+
+void RandomEngine::fillMultinomial(qint64 trials, qint64* out, std::size_t cells)
+{
+    if(cells == 0)
+        return;
+    qint64 remaining= std::max<qint64>(trials, 0);
+    for(std::size_t i= 0; i + 1 < cells; ++i)
+    {
+        // each cell takes its share of the draws the previous cells left.
+        out[i]= binomial(remaining, 1.0 / static_cast<double>(cells - i));
+        remaining-= out[i];
+    }
+    out[cells - 1]= remaining;
+}
+
+RandomEngine* RandomEngine::createStream(quint32, quint32) const
+{
+    return nullptr;
+}
+
+RandomEngine* RandomEngine::create(Dice::RANDOM_ENGINE type)
+{
+    switch(type)
+    {
+    case Dice::RANDOM_ENGINE::XOSHIRO256:
+        return new Xoshiro256Engine();
+    case Dice::RANDOM_ENGINE::PHILOX:
+        return new PhiloxEngine();
+    case Dice::RANDOM_ENGINE::MT19937:
+        break;
+    }
+    return new MersenneTwisterEngine();
+}
+
+quint64 RandomEngine::buildSeed()
+{
+    // the entropy source is opened once per process: engines built afterwards only mix a counter into it.
+    static const quint64 entropy= []() {
+        std::random_device device;
+        return (static_cast<quint64>(device()) << 32) ^ static_cast<quint64>(device());
+    }();
+    static std::atomic<quint64> counter(0);
+    quint64 seed= entropy;
+    seed^= static_cast<quint64>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    // two engines seeded in the same thread must differ even if random_device is deterministic.
+    seed+= ++counter;
+    return splitMix64(seed);
+}
+
+namespace
+{
+thread_local RandomEngine* currentThreadEngine= nullptr;
+thread_local RandomEngine* overrideThreadEngine= nullptr;
+} // namespace
+
+RandomEngine* RandomEngine::threadEngine()
+{
+    if(nullptr != currentThreadEngine)
+        return currentThreadEngine;
+    thread_local std::unique_ptr<RandomEngine> engine(create(Dice::RANDOM_ENGINE::MT19937));
+    return engine.get();
+}
+
+RandomEngine* RandomEngine::setThreadEngine(RandomEngine* engine)
+{
+    auto previous= currentThreadEngine;
+    currentThreadEngine= engine;
+    return previous;
+}
+
+RandomEngine* RandomEngine::setThreadOverride(RandomEngine* engine)
+{
+    auto previous= overrideThreadEngine;
+    overrideThreadEngine= engine;
+    return previous;
+}
+
+RandomEngine* RandomEngine::select(RandomEngine* engine)
+{
+    if(nullptr != overrideThreadEngine)
+        return overrideThreadEngine;
+    return nullptr != engine ? engine : threadEngine();
+}
+
+quint64 RandomEngine::streamSeed(quint64 seed, quint64 index)
+{
+    auto state= seed ^ splitMix64(index);
+    return splitMix64(state);
+}
+
+//////////////////////////////
+/// MersenneTwisterEngine
+//////////////////////////////
+MersenneTwisterEngine::MersenneTwisterEngine()
+{
+    seed(buildSeed());
+}
+
+MersenneTwisterEngine::MersenneTwisterEngine(quint64 value)
+{
+    seed(value);
+}
+
+RandomEngine::result_type MersenneTwisterEngine::next()
+{
+    quint64 high= m_rng();
+    quint64 low= m_rng();
+    return (high << 32) | low;
+}
+
+void MersenneTwisterEngine::seed(quint64 value)
+{
+    std::seed_seq seq{static_cast<quint32>(value), static_cast<quint32>(value >> 32)};
+    m_rng.seed(seq);
+}
+
+Dice::RANDOM_ENGINE MersenneTwisterEngine::type() const
+{
+    return Dice::RANDOM_ENGINE::MT19937;
+}
+
+//////////////////////////////
+/// Xoshiro256Engine
+//////////////////////////////
+Xoshiro256Engine::Xoshiro256Engine()
+{
+    seed(buildSeed());
+}
+
+Xoshiro256Engine::Xoshiro256Engine(quint64 value)
+{
+    seed(value);
+}
+
+RandomEngine::result_type Xoshiro256Engine::next()
+{
+    const quint64 result= rotl(m_state[1] * 5, 7) * 9;
+    const quint64 t= m_state[1] << 17;
+
+    m_state[2]^= m_state[0];
+    m_state[3]^= m_state[1];
+    m_state[1]^= m_state[2];
+    m_state[0]^= m_state[3];
+
+    m_state[2]^= t;
+    m_state[3]= rotl(m_state[3], 45);
+
+    return result;
+}
+
+void Xoshiro256Engine::seed(quint64 value)
+{
+    // splitmix64 expansion never yields the forbidden all-zero state.
+    for(auto& word : m_state)
+    {
+        word= splitMix64(value);
+    }
+}
+
+Dice::RANDOM_ENGINE Xoshiro256Engine::type() const
+{
+    return Dice::RANDOM_ENGINE::XOSHIRO256;
+}
+
+//////////////////////////////
+/// PhiloxEngine
+//////////////////////////////
+PhiloxEngine::PhiloxEngine() : PhiloxEngine(buildSeed()) {}
+
+PhiloxEngine::PhiloxEngine(quint64 value) : m_key(std::make_shared<Key>())
+{
+    seed(value);
+}
+
+RandomEngine::result_type PhiloxEngine::next()
+{
+    syncKey();
+    if(m_available == 0)
+        generateBlock();
+    return m_buffer[--m_available];
+}
+
+void PhiloxEngine::seed(quint64 value)
+{
+    // streams created from this engine share the key and restart when it changes.
+    m_key->value= value;
+    ++m_key->generation;
+    syncKey();
+}
+
+Dice::RANDOM_ENGINE PhiloxEngine::type() const
+{
+    return Dice::RANDOM_ENGINE::PHILOX;
+}
+
+void PhiloxEngine::fillBounded(qint64 base, qint64 max, qint64* out, std::size_t count)
+{
+    syncKey();
+    for(std::size_t i= 0; i < count; ++i)
+    {
+        setDieIndex(m_die);
+        RandomEngine::fillBounded(base, max, out + i, 1);
+        ++m_die;
+    }
+}
+
+RandomEngine* PhiloxEngine::createStream(quint32 instruction, quint32 node) const
+{
+    auto stream= new PhiloxEngine(*this);
+    stream->m_instruction= instruction;
+    stream->m_node= node;
+    stream->setDieIndex(0);
+    return stream;
+}
+
+void PhiloxEngine::setDieIndex(quint32 die)
+{
+    m_die= die;
+    m_block= 0;
+    m_available= 0;
+}
+
+quint32 PhiloxEngine::dieIndex() const
+{
+    return m_die;
+}
+
+void PhiloxEngine::syncKey()
+{
+    if(m_generation == m_key->generation)
+        return;
+    m_generation= m_key->generation;
+    setDieIndex(0);
+}
+
+void PhiloxEngine::generateBlock()
+{
+    const quint32 multiplier0= 0xD2511F53u;
+    const quint32 multiplier1= 0xCD9E8D57u;
+    const quint32 weyl0= 0x9E3779B9u;
+    const quint32 weyl1= 0xBB67AE85u;
+
+    quint32 key0= static_cast<quint32>(m_key->value);
+    quint32 key1= static_cast<quint32>(m_key->value >> 32);
+    std::array<quint32, 4> counter{{m_block, m_die, m_node, m_instruction}};
+    for(int round= 0; round < 10; ++round)
+    {
+        const quint64 product0= static_cast<quint64>(multiplier0) * counter[0];
+        const quint64 product1= static_cast<quint64>(multiplier1) * counter[2];
+        counter= {{static_cast<quint32>(product1 >> 32) ^ counter[1] ^ key0, static_cast<quint32>(product1),
+                   static_cast<quint32>(product0 >> 32) ^ counter[3] ^ key1, static_cast<quint32>(product0)}};
+        key0+= weyl0;
+        key1+= weyl1;
+    }
+    ++m_block;
+    // next() takes words from the back.
+    m_buffer[1]= (static_cast<quint64>(counter[1]) << 32) | counter[0];
+    m_buffer[0]= (static_cast<quint64>(counter[3]) << 32) | counter[2];
+    m_available= 2;
+}
+
+//////////////////////////////
+/// TapeRecorderEngine
+//////////////////////////////
+TapeRecorderEngine::TapeRecorderEngine(const std::shared_ptr<RandomEngine>& source) : m_source(source)
+{
+    m_tape.engine= m_source->type();
+}
+
+RandomEngine::result_type TapeRecorderEngine::next()
+{
+    auto value= m_source->next();
+    m_tape.draws.push_back(value);
+    return value;
+}
+
+void TapeRecorderEngine::seed(quint64 value)
+{
+    m_source->seed(value);
+}
+
+Dice::RANDOM_ENGINE TapeRecorderEngine::type() const
+{
+    return m_source->type();
+}
+
+const RollTape& TapeRecorderEngine::tape() const
+{
+    return m_tape;
+}
+
+void TapeRecorderEngine::clearTape()
+{
+    m_tape.draws.clear();
+}
+
+//////////////////////////////
+/// TapePlayerEngine
+//////////////////////////////
+TapePlayerEngine::TapePlayerEngine(const RollTape& tape) : m_tape(tape), m_overflow(0) {}
+
+RandomEngine::result_type TapePlayerEngine::next()
+{
+    if(m_position < m_tape.draws.size())
+        return m_tape.draws[m_position++];
+    ++m_position;
+    return m_overflow.next();
+}
+
+void TapePlayerEngine::seed(quint64)
+{
+    // a replayed execution ignores seeds, its draws are already known.
+    rewind();
+}
+
+Dice::RANDOM_ENGINE TapePlayerEngine::type() const
+{
+    return m_tape.engine;
+}
+
+const RollTape& TapePlayerEngine::tape() const
+{
+    return m_tape;
+}
+
+void TapePlayerEngine::rewind()
+{
+    m_position= 0;
+    m_overflow.seed(0);
+}
+
+bool TapePlayerEngine::exhausted() const
+{
+    return m_position > m_tape.draws.size();
+}
@@ -0,0 +1,265 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef RANDOMENGINE_H
+#define RANDOMENGINE_H
+
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "diceparserhelper.h"
+
+/**
+ * @brief The RandomEngine class is the source of randomness used to roll dice. Each DiceParser owns its engine, so
+ * parsers living in different threads never share any state. It satisfies UniformRandomBitGenerator and produces
+ * 64 bits per call.
+ */
+class RandomEngine
+{
+public:
+    using result_type= quint64;
+
+    virtual ~RandomEngine();
+    /**
+     * @brief next
+     * @return 64 random bits
+     */
+    virtual result_type next()= 0;
+    /**
+     * @brief seed resets the engine state from the given value.
+     */
+    virtual void seed(quint64 value)= 0;
+    /**
+     * @brief type
+     * @return kind of the engine
+     */
+    virtual Dice::RANDOM_ENGINE type() const= 0;
+
+    result_type operator()() { return next(); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * @brief bounded
+     * @return uniform value in [base, max]
+     */
+    qint64 bounded(qint64 base, qint64 max);
+    /**
+     * @brief fillBounded writes count uniform values in [base, max] into out. It uses Lemire's multiply-shift with
+     * rejection, and draws two values from each 64-bit word when the range fits in 32 bits.
+     */
+    virtual void fillBounded(qint64 base, qint64 max, qint64* out, std::size_t count);
+    /**
+     * @brief binomial
+     * @return number of successes among trials draws succeeding with probability p. Small means are drawn by
+     * inversion and large ones by transformed rejection (BTRS, Hörmann), so the cost does not grow with trials.
+     */
+    qint64 binomial(qint64 trials, double p);
+    /**
+     * @brief fillMultinomial spreads trials uniform draws over cells equally likely cells and writes the count of each
+     * cell into out, as a chain of conditional binomial draws.
+     */
+    void fillMultinomial(qint64 trials, qint64* out, std::size_t cells);
+    /**
+     * @brief createStream
+     * @return independent engine dedicated to one node of one instruction, or nullptr when the engine has to be
+     * shared by all nodes.
+     */
+    virtual RandomEngine* createStream(quint32 instruction, quint32 node) const;
+
+    /**
+     * @brief create builds an engine of the given type, seeded for the calling thread.
+     */
+    static RandomEngine* create(Dice::RANDOM_ENGINE type);
+    /**
+     * @brief buildSeed
+     * @return seed mixing the system entropy source with the calling thread identity.
+     */
+    static quint64 buildSeed();
+    /**
+     * @brief threadEngine
+     * @return engine of the calling thread, used when no engine has been given to a die.
+     */
+    static RandomEngine* threadEngine();
+    /**
+     * @brief setThreadEngine makes threadEngine() return the given engine in the calling thread, nullptr restores the
+     * default one.
+     * @return engine given by the previous call.
+     */
+    static RandomEngine* setThreadEngine(RandomEngine* engine);
+    /**
+     * @brief setThreadOverride makes every draw of the calling thread come from the given engine, whatever the engine
+     * held by nodes and dice. nullptr ends it.
+     * @return engine given by the previous call.
+     */
+    static RandomEngine* setThreadOverride(RandomEngine* engine);
+    /**
+     * @brief select
+     * @return engine to draw from in the calling thread for a node or a die holding engine, which may be null.
+     */
+    static RandomEngine* select(RandomEngine* engine);
+    /**
+     * @brief streamSeed
+     * @return seed of the index-th stream derived from seed, streams of different indexes are independent.
+     */
+    static quint64 streamSeed(quint64 seed, quint64 index);
+};
+
+/**
+ * @brief The MersenneTwisterEngine class wraps std::mt19937, the historical generator of DiceParser.
+ */
+class MersenneTwisterEngine : public RandomEngine
+{
+public:
+    MersenneTwisterEngine();
+    explicit MersenneTwisterEngine(quint64 value);
+
+    result_type next() override;
+    void seed(quint64 value) override;
+    Dice::RANDOM_ENGINE type() const override;
+
+private:
+    std::mt19937 m_rng;
+};
+
+/**
+ * @brief The Xoshiro256Engine class implements xoshiro256** (Blackman & Vigna). 32 bytes of state and a few
+ * arithmetic operations per draw.
+ */
+class Xoshiro256Engine : public RandomEngine
+{
+public:
+    Xoshiro256Engine();
+    explicit Xoshiro256Engine(quint64 value);
+
+    result_type next() override;
+    void seed(quint64 value) override;
+    Dice::RANDOM_ENGINE type() const override;
+
+private:
+    std::array<quint64, 4> m_state;
+};
+
+/**
+ * @brief The PhiloxEngine class is a counter-based generator (Philox4x32-10, Salmon et al.). Each draw is a pure
+ * function of (seed, instruction, node, die index, block), so any die of any node can be computed alone, in any
+ * order, on any thread. Every bounded value gets its own die index.
+ */
+class PhiloxEngine : public RandomEngine
+{
+public:
+    PhiloxEngine();
+    explicit PhiloxEngine(quint64 value);
+
+    result_type next() override;
+    void seed(quint64 value) override;
+    Dice::RANDOM_ENGINE type() const override;
+    void fillBounded(qint64 base, qint64 max, qint64* out, std::size_t count) override;
+    RandomEngine* createStream(quint32 instruction, quint32 node) const override;
+
+    /**
+     * @brief setDieIndex moves the engine to the beginning of the given die.
+     */
+    void setDieIndex(quint32 die);
+    quint32 dieIndex() const;
+
+private:
+    struct Key
+    {
+        quint64 value= 0;
+        quint64 generation= 0;
+    };
+    void syncKey();
+    void generateBlock();
+
+private:
+    std::shared_ptr<Key> m_key;
+    quint64 m_generation= 0;
+    quint32 m_instruction= 0;
+    quint32 m_node= 0;
+    quint32 m_die= 0;
+    quint32 m_block= 0;
+    std::array<quint64, 2> m_buffer;
+    std::size_t m_available= 0;
+};
+
+/**
+ * @brief The RollTape struct keeps the raw draws of one execution, in order, and the kind of engine which made them.
+ */
+struct RollTape
+{
+    Dice::RANDOM_ENGINE engine= Dice::RANDOM_ENGINE::MT19937;
+    std::vector<quint64> draws;
+};
+
+/**
+ * @brief The TapeRecorderEngine class forwards to another engine and appends every draw to a tape.
+ */
+class TapeRecorderEngine : public RandomEngine
+{
+public:
+    explicit TapeRecorderEngine(const std::shared_ptr<RandomEngine>& source);
+
+    result_type next() override;
+    void seed(quint64 value) override;
+    Dice::RANDOM_ENGINE type() const override;
+
+    const RollTape& tape() const;
+    void clearTape();
+
+private:
+    std::shared_ptr<RandomEngine> m_source;
+    RollTape m_tape;
+};
+
+/**
+ * @brief The TapePlayerEngine class gives back the draws of a tape. Once the tape is over, draws come from a
+ * xoshiro256** engine with a fixed seed so the run stays deterministic.
+ */
+class TapePlayerEngine : public RandomEngine
+{
+public:
+    explicit TapePlayerEngine(const RollTape& tape);
+
+    result_type next() override;
+    void seed(quint64 value) override;
+    Dice::RANDOM_ENGINE type() const override;
+
+    const RollTape& tape() const;
+    void rewind();
+    /**
+     * @brief exhausted
+     * @return true if more draws have been asked than the tape holds.
+     */
+    bool exhausted() const;
+
+private:
+    RollTape m_tape;
+    std::size_t m_position= 0;
+    Xoshiro256Engine m_overflow;
+};
+
+#endif // RANDOMENGINE_H
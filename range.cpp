@@ -108,6 +108,7 @@ bool Range::isEmptyRange()
 Validator* Range::getCopy() const
 {
     Range* val= new Range();
+    val->setConditionType(m_conditionType);
     val->setEmptyRange(m_emptyRange);
     if(m_hasEnd)
     {
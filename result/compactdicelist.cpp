@@ -0,0 +1,163 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "compactdicelist.h"
+
+#include <cstdlib>
+
+CompactDiceList::CompactDiceList() {}
+
+void CompactDiceList::assign(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* values,
+                             std::size_t count)
+{
+    clear();
+    m_base= base;
+    m_max= max;
+    m_op= op;
+    m_values.assign(values, values + count);
+    m_flags.assign(count, Highlighted);
+    m_colors.assign(count, 0);
+    m_firstUuid= Die::reserveUuids(count);
+}
+
+void CompactDiceList::clear()
+{
+    m_values.clear();
+    m_flags.clear();
+    m_colors.clear();
+    m_colorTable.clear();
+    m_history.clear();
+    m_firstUuid= 0;
+}
+
+std::size_t CompactDiceList::size() const
+{
+    return m_values.size();
+}
+
+bool CompactDiceList::isEmpty() const
+{
+    return m_values.empty();
+}
+
+qint64 CompactDiceList::value(std::size_t i) const
+{
+    return m_values[i];
+}
+
+QList<qint64> CompactDiceList::rolls(std::size_t i) const
+{
+    auto it= m_history.find(i);
+    if(it != m_history.end())
+        return it->second;
+    return QList<qint64>() << m_values[i];
+}
+
+void CompactDiceList::appendRoll(std::size_t i, qint64 value)
+{
+    auto it= m_history.find(i);
+    if(it == m_history.end())
+        it= m_history.insert({i, QList<qint64>() << m_values[i]}).first;
+    it->second.append(value);
+    m_values[i]= Die::combine(m_op, m_values[i], value);
+}
+
+bool CompactDiceList::testFlag(std::size_t i, Flag flag) const
+{
+    return m_flags[i] & flag;
+}
+
+void CompactDiceList::setFlag(std::size_t i, Flag flag, bool on)
+{
+    if(on)
+        m_flags[i]|= flag;
+    else
+        m_flags[i]&= static_cast<quint8>(~flag);
+}
+
+void CompactDiceList::setFlagOnAll(Flag flag, bool on)
+{
+    for(std::size_t i= 0; i < m_flags.size(); ++i)
+        setFlag(i, flag, on);
+}
+
+QString CompactDiceList::color(std::size_t i) const
+{
+    auto index= m_colors[i];
+    return index == 0 ? QStringLiteral("") : m_colorTable[index - 1];
+}
+
+void CompactDiceList::setColor(std::size_t i, const QString& color)
+{
+    if(color.isEmpty())
+    {
+        m_colors[i]= 0;
+        return;
+    }
+    auto index= m_colorTable.indexOf(color);
+    if(index < 0)
+    {
+        m_colorTable.append(color);
+        index= m_colorTable.size() - 1;
+    }
+    m_colors[i]= static_cast<quint16>(index + 1);
+}
+
+quint64 CompactDiceList::uuid(std::size_t i) const
+{
+    return m_firstUuid + i;
+}
+
+quint64 CompactDiceList::faces() const
+{
+    return static_cast<quint64>(std::abs(m_max - m_base) + 1);
+}
+
+qint64 CompactDiceList::base() const
+{
+    return m_base;
+}
+
+qint64 CompactDiceList::maxValue() const
+{
+    return m_max;
+}
+
+Die::ArithmeticOperator CompactDiceList::op() const
+{
+    return m_op;
+}
+
+Die* CompactDiceList::createDie(std::size_t i) const
+{
+    Die* die= new Die();
+    die->setUuid(uuid(i));
+    die->setOp(m_op);
+    die->setBase(m_base);
+    die->setMaxValue(m_max);
+    for(auto roll : rolls(i))
+        die->insertRollValue(roll);
+    die->setSelected(testFlag(i, Selected));
+    die->setHighlighted(testFlag(i, Highlighted));
+    die->setDisplayed(testFlag(i, Displayed));
+    die->setColor(color(i));
+    return die;
+}
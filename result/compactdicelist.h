@@ -0,0 +1,94 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef COMPACTDICELIST_H
+#define COMPACTDICELIST_H
+
+#include <QList>
+#include <QStringList>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "die.h"
+
+/**
+ * @brief The CompactDiceList class stores a pool of dice sharing the same range and operator as flat arrays. A plain
+ * roll costs 11 bytes: its value, a flag byte and a color index. Roll history only exists for dice rolled more than
+ * once and identities are contiguous, so none of them is stored per die.
+ */
+class CompactDiceList
+{
+public:
+    enum Flag : quint8
+    {
+        Selected= 0x1,
+        Highlighted= 0x2,
+        Displayed= 0x4
+    };
+
+    CompactDiceList();
+
+    /**
+     * @brief assign replaces the content with count plain rolls.
+     */
+    void assign(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* values, std::size_t count);
+    void clear();
+
+    std::size_t size() const;
+    bool isEmpty() const;
+
+    qint64 value(std::size_t i) const;
+    QList<qint64> rolls(std::size_t i) const;
+    void appendRoll(std::size_t i, qint64 value);
+
+    bool testFlag(std::size_t i, Flag flag) const;
+    void setFlag(std::size_t i, Flag flag, bool on);
+    void setFlagOnAll(Flag flag, bool on);
+
+    QString color(std::size_t i) const;
+    void setColor(std::size_t i, const QString& color);
+
+    quint64 uuid(std::size_t i) const;
+    quint64 faces() const;
+    qint64 base() const;
+    qint64 maxValue() const;
+    Die::ArithmeticOperator op() const;
+
+    /**
+     * @brief createDie
+     * @return heap die holding the same data as the die at index i.
+     */
+    Die* createDie(std::size_t i) const;
+
+private:
+    std::vector<qint64> m_values;
+    std::vector<quint8> m_flags;
+    std::vector<quint16> m_colors;
+    QStringList m_colorTable;
+    std::unordered_map<std::size_t, QList<qint64>> m_history;
+    quint64 m_firstUuid= 0;
+    qint64 m_base= 1;
+    qint64 m_max= 0;
+    Die::ArithmeticOperator m_op= Die::PLUS;
+};
+
+#endif // COMPACTDICELIST_H
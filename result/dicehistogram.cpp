@@ -0,0 +1,272 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#include "dicehistogram.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+#include "randomengine.h"
+
+namespace
+{
+template <typename B>
+auto flagCount(B& bucket, CompactDiceList::Flag flag) -> decltype((bucket.selected))
+{
+    switch(flag)
+    {
+    case CompactDiceList::Selected:
+        return bucket.selected;
+    case CompactDiceList::Highlighted:
+        return bucket.highlighted;
+    case CompactDiceList::Displayed:
+        break;
+    }
+    return bucket.displayed;
+}
+} // namespace
+
+DiceHistogram::DiceHistogram() {}
+
+void DiceHistogram::assign(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* counts,
+                           std::size_t faces)
+{
+    clear();
+    m_base= base;
+    m_max= max;
+    m_op= op;
+    quint64 total= 0;
+    for(std::size_t i= 0; i < faces; ++i)
+        total+= static_cast<quint64>(counts[i]);
+
+    // identities follow the ascending order of the roll, whatever the order the buckets get later.
+    auto uuid= Die::reserveUuids(total);
+    for(std::size_t i= 0; i < faces; ++i)
+    {
+        if(counts[i] <= 0)
+            continue;
+        Bucket bucket;
+        bucket.value= base + static_cast<qint64>(i);
+        bucket.count= static_cast<quint64>(counts[i]);
+        bucket.firstUuid= uuid;
+        bucket.highlighted= bucket.count;
+        uuid+= bucket.count;
+        m_buckets.push_back(bucket);
+    }
+    updateEnds();
+}
+
+void DiceHistogram::clear()
+{
+    m_buckets.clear();
+    m_ends.clear();
+    m_hasRollOrder= false;
+    m_order.clear();
+}
+
+void DiceHistogram::setRollOrder(quint64 seed)
+{
+    m_hasRollOrder= true;
+    m_orderSeed= seed;
+    m_order.clear();
+}
+
+bool DiceHistogram::hasRollOrder() const
+{
+    return m_hasRollOrder;
+}
+
+std::size_t DiceHistogram::position(std::size_t i) const
+{
+    if(!m_hasRollOrder)
+        return i;
+    if(m_order.size() != size())
+    {
+        // Fisher-Yates over the dice of the buckets: every order of the pool is as likely as with dice rolled one by
+        // one.
+        m_order.resize(size());
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        Xoshiro256Engine engine(m_orderSeed);
+        for(std::size_t k= m_order.size(); k > 1; --k)
+        {
+            auto j= static_cast<std::size_t>(engine.bounded(0, static_cast<qint64>(k - 1)));
+            std::swap(m_order[k - 1], m_order[j]);
+        }
+    }
+    return m_order[i];
+}
+
+std::size_t DiceHistogram::size() const
+{
+    return m_ends.empty() ? 0 : static_cast<std::size_t>(m_ends.back());
+}
+
+bool DiceHistogram::isEmpty() const
+{
+    return m_buckets.empty();
+}
+
+std::size_t DiceHistogram::bucketCount() const
+{
+    return m_buckets.size();
+}
+
+const DiceHistogram::Bucket& DiceHistogram::bucket(std::size_t b) const
+{
+    return m_buckets[b];
+}
+
+std::size_t DiceHistogram::locate(std::size_t i, quint64& offset) const
+{
+    auto it= std::upper_bound(m_ends.begin(), m_ends.end(), static_cast<quint64>(i));
+    auto b= static_cast<std::size_t>(it - m_ends.begin());
+    offset= static_cast<quint64>(i) - (m_ends[b] - m_buckets[b].count);
+    return b;
+}
+
+qint64 DiceHistogram::value(std::size_t i) const
+{
+    quint64 offset;
+    return m_buckets[locate(position(i), offset)].value;
+}
+
+bool DiceHistogram::testFlag(std::size_t i, CompactDiceList::Flag flag) const
+{
+    quint64 offset;
+    return offset < flagCount(m_buckets[locate(position(i), offset)], flag);
+}
+
+void DiceHistogram::setFlagOnBucket(std::size_t b, CompactDiceList::Flag flag, bool on)
+{
+    flagCount(m_buckets[b], flag)= on ? m_buckets[b].count : 0;
+}
+
+void DiceHistogram::setFlagOnAll(CompactDiceList::Flag flag, bool on)
+{
+    for(std::size_t b= 0; b < m_buckets.size(); ++b)
+        setFlagOnBucket(b, flag, on);
+}
+
+quint64 DiceHistogram::uuid(std::size_t i) const
+{
+    quint64 offset;
+    return m_buckets[locate(position(i), offset)].firstUuid + offset;
+}
+
+quint64 DiceHistogram::faces() const
+{
+    return static_cast<quint64>(std::abs(m_max - m_base) + 1);
+}
+
+qint64 DiceHistogram::base() const
+{
+    return m_base;
+}
+
+qint64 DiceHistogram::maxValue() const
+{
+    return m_max;
+}
+
+Die::ArithmeticOperator DiceHistogram::op() const
+{
+    return m_op;
+}
+
+qint64 DiceHistogram::sum() const
+{
+    qint64 total= 0;
+    for(auto const& bucket : m_buckets)
+        total+= bucket.value * static_cast<qint64>(bucket.count);
+    return total;
+}
+
+void DiceHistogram::sort(bool ascending)
+{
+    std::stable_sort(m_buckets.begin(), m_buckets.end(), [ascending](const Bucket& a, const Bucket& b) {
+        return ascending ? a.value < b.value : a.value > b.value;
+    });
+    updateEnds();
+    m_hasRollOrder= false;
+    m_order.clear();
+}
+
+DiceHistogram DiceHistogram::first(std::size_t count) const
+{
+    DiceHistogram histogram;
+    histogram.m_base= m_base;
+    histogram.m_max= m_max;
+    histogram.m_op= m_op;
+    auto left= static_cast<quint64>(count);
+    for(auto bucket : m_buckets)
+    {
+        if(left == 0)
+            break;
+        bucket.count= std::min(bucket.count, left);
+        bucket.selected= std::min(bucket.selected, bucket.count);
+        bucket.highlighted= std::min(bucket.highlighted, bucket.count);
+        bucket.displayed= std::min(bucket.displayed, bucket.count);
+        left-= bucket.count;
+        histogram.m_buckets.push_back(bucket);
+    }
+    histogram.updateEnds();
+    return histogram;
+}
+
+void DiceHistogram::keepFirst(std::size_t count)
+{
+    auto left= static_cast<quint64>(count);
+    for(auto& bucket : m_buckets)
+    {
+        auto kept= std::min(bucket.count, left);
+        bucket.displayed= std::max(bucket.displayed, kept);
+        bucket.highlighted= std::min(bucket.highlighted, kept);
+        left-= kept;
+    }
+}
+
+Die* DiceHistogram::createDie(std::size_t i) const
+{
+    quint64 offset;
+    auto const& bucket= m_buckets[locate(position(i), offset)];
+    Die* die= new Die();
+    die->setUuid(bucket.firstUuid + offset);
+    die->setOp(m_op);
+    die->setBase(m_base);
+    die->setMaxValue(m_max);
+    die->insertRollValue(bucket.value);
+    die->setSelected(offset < bucket.selected);
+    die->setHighlighted(offset < bucket.highlighted);
+    die->setDisplayed(offset < bucket.displayed);
+    return die;
+}
+
+void DiceHistogram::updateEnds()
+{
+    m_ends.resize(m_buckets.size());
+    quint64 end= 0;
+    for(std::size_t b= 0; b < m_buckets.size(); ++b)
+    {
+        end+= m_buckets[b].count;
+        m_ends[b]= end;
+    }
+}
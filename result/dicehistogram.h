@@ -0,0 +1,128 @@
+/***************************************************************************
+ * Copyright (C) 2014 by Renaud Guezennec                                   *
+ * https://rolisteam.org/contact                      *
+ *                                                                          *
+ *  This file is part of DiceParser                                         *
+ *                                                                          *
+ * DiceParser is free software; you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by     *
+ * the Free Software Foundation; either version 2 of the License, or        *
+ * (at your option) any later version.                                      *
+ *                                                                          *
+ * This program is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+ * GNU General Public License for more details.                             *
+ *                                                                          *
+ * You should have received a copy of the GNU General Public License        *
+ * along with this program; if not, write to the                            *
+ * Free Software Foundation, Inc.,                                          *
+ * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+ ***************************************************************************/
+#ifndef DICEHISTOGRAM_H
+#define DICEHISTOGRAM_H
+
+#include <cstddef>
+#include <vector>
+
+#include "compactdicelist.h"
+#include "die.h"
+
+/**
+ * @brief The DiceHistogram class stores a pool of plain rolls sharing the same range as one bucket per face value:
+ * the value, how many dice show it and their flags. Memory and time depend on the number of faces instead of the number
+ * of dice. Dice are read bucket after bucket, unless the histogram has a roll order: a random permutation of its dice,
+ * drawn the first time a die is read, so a pool shown die by die looks like dice rolled one after the other.
+ */
+class DiceHistogram
+{
+public:
+    struct Bucket
+    {
+        qint64 value= 0;
+        quint64 count= 0;
+        quint64 firstUuid= 0;
+        // a flag is set on the first dice of the bucket only, these are their numbers.
+        quint64 selected= 0;
+        quint64 highlighted= 0;
+        quint64 displayed= 0;
+    };
+
+    DiceHistogram();
+
+    /**
+     * @brief assign replaces the content with counts[i] dice showing base + i, in ascending order.
+     */
+    void assign(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* counts, std::size_t faces);
+    void clear();
+    /**
+     * @brief setRollOrder makes dice read in the order of a permutation drawn from seed, instead of bucket after
+     * bucket. sort() and assign() remove it.
+     */
+    void setRollOrder(quint64 seed);
+    bool hasRollOrder() const;
+
+    std::size_t size() const;
+    bool isEmpty() const;
+
+    std::size_t bucketCount() const;
+    const Bucket& bucket(std::size_t b) const;
+    /**
+     * @brief locate
+     * @return bucket of the i-th die, read bucket after bucket, its position inside the bucket is stored in offset.
+     */
+    std::size_t locate(std::size_t i, quint64& offset) const;
+
+    qint64 value(std::size_t i) const;
+    bool testFlag(std::size_t i, CompactDiceList::Flag flag) const;
+    void setFlagOnBucket(std::size_t b, CompactDiceList::Flag flag, bool on);
+    void setFlagOnAll(CompactDiceList::Flag flag, bool on);
+    quint64 uuid(std::size_t i) const;
+
+    quint64 faces() const;
+    qint64 base() const;
+    qint64 maxValue() const;
+    Die::ArithmeticOperator op() const;
+    /**
+     * @brief sum
+     * @return total of all dice values.
+     */
+    qint64 sum() const;
+
+    /**
+     * @brief sort orders the buckets by value.
+     */
+    void sort(bool ascending);
+    /**
+     * @brief first
+     * @return histogram holding copies of the count first dice of the buckets, without roll order.
+     */
+    DiceHistogram first(std::size_t count) const;
+    /**
+     * @brief keepFirst marks the count first dice as displayed and the others as not highlighted.
+     */
+    void keepFirst(std::size_t count);
+
+    /**
+     * @brief createDie
+     * @return heap die holding the same data as the i-th die.
+     */
+    Die* createDie(std::size_t i) const;
+
+private:
+    void updateEnds();
+    std::size_t position(std::size_t i) const;
+
+private:
+    std::vector<Bucket> m_buckets;
+    std::vector<quint64> m_ends;
+    qint64 m_base= 1;
+    qint64 m_max= 0;
+    Die::ArithmeticOperator m_op= Die::PLUS;
+    bool m_hasRollOrder= false;
+    quint64 m_orderSeed= 0;
+    // built on first read: position of each die of the roll order in bucket order.
+    mutable std::vector<quint32> m_order;
+};
+
+#endif // DICEHISTOGRAM_H
@@ -23,19 +23,170 @@
 #include "diceresult.h"
 #include <QDebug>
 
+DieView::DieView(const Die* die) : m_die(die) {}
+
+DieView::DieView(const CompactDiceList* list, std::size_t index) : m_list(list), m_index(index) {}
+
+DieView::DieView(const DiceHistogram* histogram, std::size_t index) : m_histogram(histogram), m_index(index) {}
+
+qint64 DieView::getValue() const
+{
+    if(m_histogram)
+        return m_histogram->value(m_index);
+    return m_die ? m_die->getValue() : m_list->value(m_index);
+}
+
+QList<qint64> DieView::getListValue() const
+{
+    if(m_histogram)
+        return QList<qint64>() << m_histogram->value(m_index);
+    return m_die ? m_die->getListValue() : m_list->rolls(m_index);
+}
+
+bool DieView::isSelected() const
+{
+    if(m_histogram)
+        return m_histogram->testFlag(m_index, CompactDiceList::Selected);
+    return m_die ? m_die->isSelected() : m_list->testFlag(m_index, CompactDiceList::Selected);
+}
+
+bool DieView::isHighlighted() const
+{
+    if(m_histogram)
+        return m_histogram->testFlag(m_index, CompactDiceList::Highlighted);
+    return m_die ? m_die->isHighlighted() : m_list->testFlag(m_index, CompactDiceList::Highlighted);
+}
+
+bool DieView::hasBeenDisplayed() const
+{
+    if(m_histogram)
+        return m_histogram->testFlag(m_index, CompactDiceList::Displayed);
+    return m_die ? m_die->hasBeenDisplayed() : m_list->testFlag(m_index, CompactDiceList::Displayed);
+}
+
+QString DieView::getColor() const
+{
+    if(m_histogram)
+        return QStringLiteral("");
+    return m_die ? m_die->getColor() : m_list->color(m_index);
+}
+
+quint64 DieView::getFaces() const
+{
+    if(m_histogram)
+        return m_histogram->faces();
+    return m_die ? m_die->getFaces() : m_list->faces();
+}
+
+quint64 DieView::getUuid() const
+{
+    if(m_histogram)
+        return m_histogram->uuid(m_index);
+    return m_die ? m_die->getUuid() : m_list->uuid(m_index);
+}
+
+DiceResult::const_iterator::const_iterator(const DiceResult* result, int index) : m_result(result), m_index(index) {}
+
+DieView DiceResult::const_iterator::operator*() const
+{
+    if(!m_result->m_compactValues.isEmpty())
+        return DieView(&m_result->m_compactValues, static_cast<std::size_t>(m_index));
+    if(!m_result->m_histogram.isEmpty())
+        return DieView(&m_result->m_histogram, static_cast<std::size_t>(m_index));
+    return DieView(m_result->m_diceValues[m_index]);
+}
+
+DiceResult::const_iterator& DiceResult::const_iterator::operator++()
+{
+    ++m_index;
+    return *this;
+}
+
+bool DiceResult::const_iterator::operator==(const const_iterator& other) const
+{
+    return m_result == other.m_result && m_index == other.m_index;
+}
+
+bool DiceResult::const_iterator::operator!=(const const_iterator& other) const
+{
+    return !(*this == other);
+}
+
+DiceResult::const_iterator DiceResult::DiceView::begin() const
+{
+    return const_iterator(m_result, 0);
+}
+
+DiceResult::const_iterator DiceResult::DiceView::end() const
+{
+    return const_iterator(m_result, m_result->diceCount());
+}
+
 DiceResult::DiceResult() : m_operator(Die::PLUS)
 {
     m_resultTypes= (static_cast<int>(Dice::RESULT_TYPE::DICE_LIST) | static_cast<int>(Dice::RESULT_TYPE::SCALAR));
+    m_kind= Kind::Dice;
     m_homogeneous= true;
 }
 void DiceResult::insertResult(Die* die)
 {
+    expandCompactResult();
     m_diceValues.append(die);
 }
 QList<Die*>& DiceResult::getResultList()
 {
+    expandCompactResult();
     return m_diceValues;
 }
+DiceResult::DiceView DiceResult::view() const
+{
+    return DiceView{this};
+}
+int DiceResult::diceCount() const
+{
+    if(!m_histogram.isEmpty())
+        return static_cast<int>(m_histogram.size());
+    return m_compactValues.isEmpty() ? m_diceValues.size() : static_cast<int>(m_compactValues.size());
+}
+void DiceResult::setCompactResult(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* values,
+                                  std::size_t count)
+{
+    qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    m_diceValues.clear();
+    m_histogram.clear();
+    m_compactValues.assign(base, max, op, values, count);
+}
+void DiceResult::setHistogram(const DiceHistogram& histogram)
+{
+    qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    m_diceValues.clear();
+    m_compactValues.clear();
+    m_histogram= histogram;
+}
+DiceHistogram* DiceResult::histogram()
+{
+    return m_histogram.isEmpty() ? nullptr : &m_histogram;
+}
+void DiceResult::expandCompactResult()
+{
+    if(!m_histogram.isEmpty())
+    {
+        m_diceValues.reserve(m_diceValues.size() + static_cast<int>(m_histogram.size()));
+        for(std::size_t i= 0; i < m_histogram.size(); ++i)
+        {
+            m_diceValues.append(m_histogram.createDie(i));
+        }
+        m_histogram.clear();
+    }
+    if(m_compactValues.isEmpty())
+        return;
+    m_diceValues.reserve(m_diceValues.size() + static_cast<int>(m_compactValues.size()));
+    for(std::size_t i= 0; i < m_compactValues.size(); ++i)
+    {
+        m_diceValues.append(m_compactValues.createDie(i));
+    }
+    m_compactValues.clear();
+}
 bool DiceResult::isHomogeneous() const
 {
     return m_homogeneous;
@@ -47,6 +198,8 @@ void DiceResult::setHomogeneous(bool b)
 
 void DiceResult::setResultList(QList<Die*> list)
 {
+    m_compactValues.clear();
+    m_histogram.clear();
     m_diceValues.erase(
         std::remove_if(m_diceValues.begin(), m_diceValues.end(), [list](Die* die) { return list.contains(die); }),
         m_diceValues.end());
@@ -73,6 +226,7 @@ QVariant DiceResult::getResult(Dice::RESULT_TYPE type)
     }
     case Dice::RESULT_TYPE::DICE_LIST:
     {
+        expandCompactResult();
         return QVariant::fromValue(m_diceValues);
     }
     default:
@@ -82,6 +236,7 @@ QVariant DiceResult::getResult(Dice::RESULT_TYPE type)
 }
 bool DiceResult::contains(Die* die, const std::function<bool(const Die*, const Die*)> equal)
 {
+    expandCompactResult();
     for(auto& value : m_diceValues)
     {
         if(equal(value, die))
@@ -93,37 +248,41 @@ bool DiceResult::contains(Die* die, const std::function<bool(const Die*, const D
 }
 qreal DiceResult::getScalarResult()
 {
-    if(m_diceValues.size() == 1)
+    if(diceCount() == 1)
     {
-        return m_diceValues[0]->getValue();
+        return (*view().begin()).getValue();
+    }
+    else if(!m_histogram.isEmpty() && m_operator == Die::PLUS)
+    {
+        return m_histogram.sum();
     }
     else
     {
         qint64 scalar= 0;
         int i= 0;
-        for(auto& tmp : m_diceValues)
+        for(const auto& tmp : view())
         {
             if(i > 0)
             {
                 switch(m_operator)
                 {
                 case Die::PLUS:
-                    scalar+= tmp->getValue();
+                    scalar+= tmp.getValue();
                     break;
                 case Die::MULTIPLICATION:
-                    scalar*= tmp->getValue();
+                    scalar*= tmp.getValue();
                     break;
                 case Die::MINUS:
-                    scalar-= tmp->getValue();
+                    scalar-= tmp.getValue();
                     break;
                 case Die::POW:
-                    scalar= static_cast<int>(pow(static_cast<double>(scalar), static_cast<double>(tmp->getValue())));
+                    scalar= static_cast<int>(pow(static_cast<double>(scalar), static_cast<double>(tmp.getValue())));
                     break;
                 case Die::DIVIDE:
                 case Die::INTEGER_DIVIDE:
-                    if(tmp->getValue() != 0)
+                    if(tmp.getValue() != 0)
                     {
-                        scalar/= tmp->getValue();
+                        scalar/= tmp.getValue();
                     }
                     else
                     {
@@ -134,7 +293,7 @@ qreal DiceResult::getScalarResult()
             }
             else
             {
-                scalar= tmp->getValue();
+                scalar= tmp.getValue();
             }
             ++i;
         }
@@ -150,6 +309,15 @@ Die::ArithmeticOperator DiceResult::getOperator() const
 void DiceResult::clear()
 {
     m_diceValues.clear();
+    m_compactValues.clear();
+    m_histogram.clear();
+}
+
+void DiceResult::reset()
+{
+    qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    Result::reset();
+    m_homogeneous= true;
 }
 
 void DiceResult::setOperator(const Die::ArithmeticOperator& dieOperator)
@@ -159,18 +327,18 @@ void DiceResult::setOperator(const Die::ArithmeticOperator& dieOperator)
 QString DiceResult::toString(bool wl)
 {
     QStringList scalarSum;
-    for(auto& die : m_diceValues)
+    for(const auto& die : view())
     {
-        scalarSum << QString::number(die->getValue());
+        scalarSum << QString::number(die.getValue());
     }
     if(wl)
     {
         return QStringLiteral("%3 [label=\"DiceResult Value %1 dice %2\"]")
-            .arg(QString::number(getScalarResult()), scalarSum.join('_'), m_id);
+            .arg(QString::number(getScalarResult()), scalarSum.join('_'), dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 Result* DiceResult::getCopy() const
@@ -188,6 +356,10 @@ Result* DiceResult::getCopy() const
         list.append(newdie);
     }
     copy->setResultList(list);
+    copy->m_compactValues= m_compactValues;
+    copy->m_compactValues.setFlagOnAll(CompactDiceList::Displayed, false);
+    copy->m_histogram= m_histogram;
+    copy->m_histogram.setFlagOnAll(CompactDiceList::Displayed, false);
     copy->setPrevious(getPrevious());
     return copy;
 }
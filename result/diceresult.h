@@ -24,8 +24,36 @@
 #include <QList>
 #include <functional>
 
+#include "compactdicelist.h"
+#include "dicehistogram.h"
 #include "die.h"
 #include "result.h"
+
+/**
+ * @brief The DieView class gives read access to one die of a DiceResult, whatever its storage.
+ */
+class DieView
+{
+public:
+    DieView(const Die* die);
+    DieView(const CompactDiceList* list, std::size_t index);
+    DieView(const DiceHistogram* histogram, std::size_t index);
+
+    qint64 getValue() const;
+    QList<qint64> getListValue() const;
+    bool isSelected() const;
+    bool isHighlighted() const;
+    bool hasBeenDisplayed() const;
+    QString getColor() const;
+    quint64 getFaces() const;
+    quint64 getUuid() const;
+
+private:
+    const Die* m_die= nullptr;
+    const CompactDiceList* m_list= nullptr;
+    const DiceHistogram* m_histogram= nullptr;
+    std::size_t m_index= 0;
+};
 /**
  * @brief The DiceResult class
  */
@@ -41,11 +69,54 @@ public:
      */
     virtual ~DiceResult() override;
 
+    class const_iterator
+    {
+    public:
+        const_iterator(const DiceResult* result, int index);
+        DieView operator*() const;
+        const_iterator& operator++();
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        const DiceResult* m_result;
+        int m_index;
+    };
+    /**
+     * @brief The DiceView struct allows range-for loops on the dice without building any Die.
+     */
+    struct DiceView
+    {
+        const_iterator begin() const;
+        const_iterator end() const;
+        const DiceResult* m_result;
+    };
+
     /**
      * @brief getResultList
-     * @return
+     * @return dice as Die objects, compact dice and histograms are converted on first call.
      */
     virtual QList<Die*>& getResultList();
+    /**
+     * @brief view
+     * @return read-only access to the dice, prefer it to getResultList when no die is modified.
+     */
+    DiceView view() const;
+    int diceCount() const;
+    /**
+     * @brief setCompactResult stores plain rolls sharing the same range in compact form.
+     */
+    void setCompactResult(qint64 base, qint64 max, Die::ArithmeticOperator op, const qint64* values,
+                          std::size_t count);
+    /**
+     * @brief setHistogram stores the dice as counts per face value, see DiceHistogram.
+     */
+    void setHistogram(const DiceHistogram& histogram);
+    /**
+     * @brief histogram
+     * @return histogram of the dice, nullptr unless they are stored that way.
+     */
+    DiceHistogram* histogram();
     /**
      * @brief insertResult
      */
@@ -81,14 +152,18 @@ public:
     bool contains(Die* die, const std::function<bool(const Die*, const Die*)> equal);
 
     void clear() override;
+    void reset() override;
 
     virtual Result* getCopy() const override;
 
 protected:
     qreal getScalarResult();
+    void expandCompactResult();
 
 protected:
     QList<Die*> m_diceValues;
+    CompactDiceList m_compactValues;
+    DiceHistogram m_histogram;
     bool m_homogeneous;
     Die::ArithmeticOperator m_operator= Die::ArithmeticOperator::PLUS;
 };
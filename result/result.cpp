@@ -20,11 +20,20 @@
  * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
  ***************************************************************************/
 #include "result.h"
-#include <QUuid>
+#include <atomic>
+
+#include "diceresult.h"
+#include "scalarresult.h"
+#include "stringresult.h"
+
+namespace
+{
+std::atomic<quint64> s_lastResultId(0);
+}
 
 Result::Result()
     : m_resultTypes(static_cast<int>(Dice::RESULT_TYPE::NONE))
-    , m_id(QString("\"%1\"").arg(QUuid::createUuid().toString()))
+    , m_id(s_lastResultId.fetch_add(1, std::memory_order_relaxed) + 1)
     , m_previous(nullptr)
 {
 }
@@ -41,11 +50,43 @@ void Result::setPrevious(Result* p)
     m_previous= p;
 }
 
+Result::Kind Result::kind() const
+{
+    return m_kind;
+}
+
+DiceResult* Result::asDice(Result* result)
+{
+    // StringResult derives from DiceResult.
+    if(nullptr == result || Kind::Scalar == result->m_kind)
+        return nullptr;
+    return static_cast<DiceResult*>(result);
+}
+
+ScalarResult* Result::asScalar(Result* result)
+{
+    if(nullptr == result || Kind::Scalar != result->m_kind)
+        return nullptr;
+    return static_cast<ScalarResult*>(result);
+}
+
+StringResult* Result::asString(Result* result)
+{
+    if(nullptr == result || Kind::String != result->m_kind)
+        return nullptr;
+    return static_cast<StringResult*>(result);
+}
+
 bool Result::isStringResult() const
 {
     return false;
 }
 void Result::clear() {}
+void Result::reset()
+{
+    clear();
+    m_previous= nullptr;
+}
 bool Result::hasResultOfType(Dice::RESULT_TYPE type) const
 {
     return (m_resultTypes & static_cast<int>(type));
@@ -75,11 +116,16 @@ void Result::generateDotTree(QString& s)
     }
 }
 
-QString Result::getId() const
+quint64 Result::getId() const
 {
     return m_id;
 }
 
+QString Result::dotId() const
+{
+    return QStringLiteral("\"r%1\"").arg(m_id);
+}
+
 QString Result::getStringResult() const
 {
     return {};
@@ -22,15 +22,29 @@
 #ifndef RESULT_H
 #define RESULT_H
 
+#include "dicearena.h"
 #include "diceparserhelper.h"
 #include <QString>
 #include <QVariant>
+
+class DiceResult;
+class ScalarResult;
+class StringResult;
 /**
  * @brief The Result class
  */
-class Result
+class Result : public ArenaObject
 {
 public:
+    /**
+     * @brief The Kind enum tells the class of a result, so nodes can reach it without dynamic_cast.
+     */
+    enum class Kind : quint8
+    {
+        Scalar,
+        Dice,
+        String
+    };
     /**
      * @brief Result
      */
@@ -66,6 +80,10 @@ public:
     virtual bool isStringResult() const;
 
     virtual void clear();
+    /**
+     * @brief reset empties the result before its node runs again, and frees what the result owns.
+     */
+    virtual void reset();
 
     /**
      * @brief getStringResult
@@ -83,11 +101,32 @@ public:
     virtual QString toString(bool wl)= 0;
     virtual Result* getCopy() const= 0;
 
-    QString getId() const;
+    /**
+     * @brief getId
+     * @return number identifying the result, shared by its copies.
+     */
+    quint64 getId() const;
+
+    Kind kind() const;
+    /**
+     * @brief asDice
+     * @return result as a DiceResult, string results included, nullptr if result is null or holds a scalar.
+     */
+    static DiceResult* asDice(Result* result);
+    static ScalarResult* asScalar(Result* result);
+    static StringResult* asString(Result* result);
+
+protected:
+    /**
+     * @brief dotId
+     * @return id of the result as a DOT node name.
+     */
+    QString dotId() const;
 
 protected:
     int m_resultTypes; /// @brief
-    QString m_id;
+    Kind m_kind= Kind::Scalar;
+    quint64 m_id;
 
 private:
     Result* m_previous= nullptr; /// @brief
@@ -24,6 +24,7 @@
 ScalarResult::ScalarResult()
 {
     m_resultTypes= static_cast<int>(Dice::RESULT_TYPE::SCALAR);
+    m_kind= Kind::Scalar;
 }
 
 void ScalarResult::setValue(qreal i)
@@ -39,6 +40,12 @@ QVariant ScalarResult::getResult(Dice::RESULT_TYPE type)
     else
         return {};
 }
+void ScalarResult::reset()
+{
+    Result::reset();
+    m_value= 0;
+}
+
 Result* ScalarResult::getCopy() const
 {
     auto copy= new ScalarResult();
@@ -49,10 +56,10 @@ QString ScalarResult::toString(bool wl)
 {
     if(wl)
     {
-        return QString("%2 [label=\"ScalarResult %1\"]").arg(m_value).arg(m_id);
+        return QString("%2 [label=\"ScalarResult %1\"]").arg(m_value).arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
@@ -51,6 +51,7 @@ public:
      */
     virtual QString toString(bool);
     virtual Result* getCopy() const;
+    virtual void reset();
 
 private:
     qreal m_value= 0;
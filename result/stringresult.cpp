@@ -5,12 +5,20 @@ StringResult::StringResult()
 {
     m_highlight= true;
     m_resultTypes= static_cast<int>(Dice::RESULT_TYPE::STRING);
+    m_kind= Kind::String;
 }
 void StringResult::addText(QString text)
 {
     m_value.append(text);
 }
 StringResult::~StringResult() {}
+void StringResult::reset()
+{
+    DiceResult::reset();
+    m_value.clear();
+    m_highlight= true;
+    m_stringCount= 0;
+}
 bool StringResult::hasResultOfType(Dice::RESULT_TYPE resultType) const
 {
     bool val= false;
@@ -51,11 +59,11 @@ QString StringResult::toString(bool wl)
 {
     if(wl)
     {
-        return QString("%2 [label=\"StringResult_value_%1\"]").arg(getText().replace("%", "_"), m_id);
+        return QString("%2 [label=\"StringResult_value_%1\"]").arg(getText().replace("%", "_"), dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 void StringResult::setHighLight(bool b)
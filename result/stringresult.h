@@ -28,6 +28,7 @@ public:
     virtual bool hasHighLight() const;
     virtual bool hasResultOfType(Dice::RESULT_TYPE resultType) const override;
     virtual Result* getCopy() const override;
+    void reset() override;
 
     bool isDigitOnly() const;
 
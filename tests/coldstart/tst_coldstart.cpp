@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Renaud Guezennec                                *
+ *   http://renaudguezennec.homelinux.org/accueil,3.html                   *
+ *                                                                         *
+ *   Rolisteam is free software; you can redistribute it and/or modify     *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QProcess>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <vector>
+
+#ifndef DICE_CLI_PATH
+#define DICE_CLI_PATH "dice"
+#endif
+
+// set by the build from DICE_COLDSTART_THRESHOLD_MS.
+#ifndef COLDSTART_THRESHOLD_MS
+#error "COLDSTART_THRESHOLD_MS is not defined"
+#endif
+
+/**
+ * @brief The TestColdStart class measures the time a fresh dice process takes to print its first result, which is
+ * what a one-shot bot pays for each message.
+ */
+class TestColdStart : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestColdStart();
+
+private slots:
+    void timeToFirstResult();
+    void timeToFirstResult_data();
+
+private:
+    qint64 runOnce(const QStringList& args, QByteArray& output);
+};
+
+TestColdStart::TestColdStart() {}
+
+qint64 TestColdStart::runOnce(const QStringList& args, QByteArray& output)
+{
+    QProcess process;
+    auto env= QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+    process.setProcessEnvironment(env);
+
+    QElapsedTimer timer;
+    timer.start();
+    process.start(QStringLiteral(DICE_CLI_PATH), args);
+    if(!process.waitForFinished(10000))
+        return -1;
+    auto elapsed= timer.elapsed();
+    output= process.readAllStandardOutput();
+    return elapsed;
+}
+
+void TestColdStart::timeToFirstResult()
+{
+    QFETCH(QStringList, args);
+
+    const int runs= 7;
+    std::vector<qint64> times;
+    for(int i= 0; i < runs; ++i)
+    {
+        QByteArray output;
+        auto elapsed= runOnce(args, output);
+        QVERIFY2(elapsed >= 0, "dice did not finish");
+        QVERIFY2(!output.isEmpty(), "no result");
+        times.push_back(elapsed);
+    }
+
+    std::sort(times.begin(), times.end());
+    auto median= times[runs / 2];
+    qInfo() << "time to first result:" << median << "ms (median), best" << times.front() << "ms, threshold"
+            << COLDSTART_THRESHOLD_MS << "ms";
+    QVERIFY2(median <= COLDSTART_THRESHOLD_MS, "cold start is slower than the threshold");
+}
+
+void TestColdStart::timeToFirstResult_data()
+{
+    QTest::addColumn<QStringList>("args");
+
+    QTest::addRow("bot") << QStringList({QStringLiteral("-b"), QStringLiteral("3d6+2")});
+    QTest::addRow("botList") << QStringList(
+        {QStringLiteral("-b"), QStringLiteral("1L[tete[10],ventre[50],jambe[40]]")});
+    QTest::addRow("botAlias") << QStringList(
+        {QStringLiteral("-b"), QStringLiteral("--alias-data"),
+         QStringLiteral("[{\"pattern\":\"!att\",\"cmd\":\"1d20+5\",\"regexp\":false},"
+                        "{\"pattern\":\"(\\\\d+)w\",\"cmd\":\"\\\\1d10e10c[>=7]\",\"regexp\":true}]"),
+         QStringLiteral("!att;5w")});
+}
+
+QTEST_MAIN(TestColdStart)
+
+#include "tst_coldstart.moc"
@@ -21,11 +21,11 @@ QString TestNode::toString(bool wl) const
 {
     if(wl)
     {
-        return QStringLiteral("%1 [label=\"TestNode \"]").arg(m_id);
+        return QStringLiteral("%1 [label=\"TestNode \"]").arg(dotId());
     }
     else
     {
-        return m_id;
+        return dotId();
     }
 }
 qint64 TestNode::getPriority() const
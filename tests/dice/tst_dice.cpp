@@ -20,16 +20,25 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QString>
+#include <QtCore/QThreadPool>
 #include <QtTest/QtTest>
 
+#include <atomic>
+#include <functional>
+#include <thread>
+
 #include "dicealias.h"
+#include "dicearena.h"
 #include "diceparser.h"
+#include "diceprogram.h"
 #include "die.h"
+#include "instructionschedule.h"
 
 // node
 #include "booleancondition.h"
 #include "node/bind.h"
 #include "node/countexecutenode.h"
+#include "node/dicerollernode.h"
 #include "node/explodedicenode.h"
 #include "node/filternode.h"
 #include "node/groupnode.h"
@@ -39,12 +48,16 @@
 #include "node/numbernode.h"
 #include "node/occurencecountnode.h"
 #include "node/rerolldicenode.h"
+#include "node/scalaroperatornode.h"
 #include "node/sortresult.h"
 #include "node/splitnode.h"
 #include "node/stringnode.h"
 #include "node/uniquenode.h"
 #include "operationcondition.h"
 #include "parsingtoolbox.h"
+#include "randomengine.h"
+#include "result/compactdicelist.h"
+#include "result/scalarresult.h"
 #include "result/stringresult.h"
 #include "testnode.h"
 #include "validatorlist.h"
@@ -103,6 +116,14 @@ ValidatorList* makeValidator(QVector<int> number, BooleanCondition::LogicOperato
     return list;
 }
 
+QString rollOutput(const DiceParser& parser)
+{
+    // the whole output of the last run: scalars, strings, dice, colors and highlights.
+    return parser.resultAsJSon([](const QString& result, const QString& color, bool highlight) {
+        return QStringLiteral("%1:%2:%3").arg(result, color).arg(highlight);
+    });
+}
+
 class TestDice : public QObject
 {
     Q_OBJECT
@@ -119,6 +140,51 @@ private slots:
 
     void diceRollD10Test();
     void diceRollD20Test();
+    void randomEngineTest();
+    void randomEngineTest_data();
+    void batchRollTest();
+    void batchRollTest_data();
+    void compactDiceTest();
+    void histogramTest();
+    void histogramTest_data();
+    void histogramOrderTest();
+    void histogramDisplayTest();
+    void histogramDisplayTest_data();
+    void philoxStreamTest();
+    void philoxKnownAnswerTest();
+    void dieValueTest();
+    void dieSharingTest();
+    void explodeSortBenchmark();
+    void resultKindBenchmark();
+    void resultKindBenchmark_data();
+    void repeatTurnBenchmark();
+    void repeatTurnBenchmark_data();
+    void rollTapeTest();
+    void preparedCommandTest();
+    void planCacheTest();
+    void arenaAllocationTest();
+    void arenaAllocationTest_data();
+    void bytecodeTest();
+    void bytecodeTest_data();
+    void executionBudgetTest();
+    void executionBudgetTest_data();
+    void poolSizeLimitTest();
+    void poolSizeLimitTest_data();
+    void executionCancelTest();
+    void costEstimateTest();
+    void costEstimateTest_data();
+    void repeatTest();
+    void repeatTest_data();
+    void parallelRepeatTest();
+    void parallelRepeatTest_data();
+    void instructionScheduleTest();
+    void instructionScheduleTest_data();
+    void parallelInstructionTest();
+    void parallelInstructionTest_data();
+    void constantFoldingTest();
+    void constantFoldingTest_data();
+    void outputCacheTest();
+    void outputCacheTest_data();
     void commandEndlessLoop();
 
     void mathPriority();
@@ -226,6 +292,11 @@ void TestDice::getAndSetTest()
 
     m_die->setSelected(false);
     QVERIFY(m_die->isSelected() == false);
+
+    Die copy(*m_die);
+    Die other;
+    QCOMPARE(copy.getUuid(), m_die->getUuid());
+    QVERIFY(other.getUuid() != m_die->getUuid());
 }
 
 void TestDice::validatorListTest()
@@ -278,6 +349,1161 @@ void TestDice::diceRollD20Test()
     }
 }
 
+void TestDice::randomEngineTest()
+{
+    QFETCH(int, type);
+    QFETCH(QString, cmd);
+
+    auto engine= static_cast<Dice::RANDOM_ENGINE>(type);
+    m_diceParser->setRandomEngine(engine);
+    QCOMPARE(m_diceParser->randomEngine()->type(), engine);
+
+    std::unique_ptr<RandomEngine> rng(RandomEngine::create(engine));
+    for(int i= 0; i < 2000; i++)
+    {
+        auto value= rng->bounded(-3, 3);
+        QVERIFY(value >= -3);
+        QVERIFY(value <= 3);
+    }
+
+    m_diceParser->setSeed(42);
+    QVERIFY(m_diceParser->parseLine(cmd));
+    m_diceParser->start();
+    auto first= rollOutput(*m_diceParser);
+
+    m_diceParser->setSeed(42);
+    QVERIFY(m_diceParser->parseLine(cmd));
+    m_diceParser->start();
+    auto second= rollOutput(*m_diceParser);
+
+    QVERIFY(!first.isEmpty());
+    QCOMPARE(first, second);
+}
+
+void TestDice::randomEngineTest_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<QString>("cmd");
+
+    QTest::addRow("mt1") << static_cast<int>(Dice::RANDOM_ENGINE::MT19937) << "20d10";
+    QTest::addRow("mt2") << static_cast<int>(Dice::RANDOM_ENGINE::MT19937) << "10d6e6r1";
+    QTest::addRow("xoshiro1") << static_cast<int>(Dice::RANDOM_ENGINE::XOSHIRO256) << "20d10";
+    QTest::addRow("xoshiro2") << static_cast<int>(Dice::RANDOM_ENGINE::XOSHIRO256) << "10d6e6r1";
+    QTest::addRow("xoshiro3") << static_cast<int>(Dice::RANDOM_ENGINE::XOSHIRO256) << "3L[a,b,c,d]";
+    QTest::addRow("philox1") << static_cast<int>(Dice::RANDOM_ENGINE::PHILOX) << "20d10";
+    QTest::addRow("philox2") << static_cast<int>(Dice::RANDOM_ENGINE::PHILOX) << "10d6e6r1;4d8";
+}
+
+void TestDice::batchRollTest()
+{
+    QFETCH(qint64, min);
+    QFETCH(qint64, max);
+    QFETCH(int, count);
+
+    std::unique_ptr<RandomEngine> rng(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    std::vector<qint64> values(static_cast<std::size_t>(count));
+    rng->fillBounded(min, max, values.data(), values.size());
+    std::set<qint64> seen;
+    for(auto value : values)
+    {
+        QVERIFY(value >= min);
+        QVERIFY(value <= max);
+        seen.insert(value);
+    }
+    if(max - min < 20)
+        QCOMPARE(seen.size(), static_cast<std::size_t>(max - min + 1));
+}
+
+void TestDice::batchRollTest_data()
+{
+    QTest::addColumn<qint64>("min");
+    QTest::addColumn<qint64>("max");
+    QTest::addColumn<int>("count");
+
+    QTest::addRow("d1") << qint64(1) << qint64(1) << 10;
+    QTest::addRow("d6") << qint64(1) << qint64(6) << 10001;
+    QTest::addRow("d20") << qint64(1) << qint64(20) << 10000;
+    QTest::addRow("negative") << qint64(-5) << qint64(5) << 10000;
+    QTest::addRow("coin") << qint64(0) << qint64(1) << 1000;
+    QTest::addRow("huge") << qint64(-(1ll << 40)) << qint64(1ll << 40) << 10000;
+}
+
+void TestDice::philoxStreamTest()
+{
+    PhiloxEngine engine(42);
+    std::unique_ptr<RandomEngine> whole(engine.createStream(0, 0));
+    std::unique_ptr<RandomEngine> chunks(engine.createStream(0, 0));
+    std::unique_ptr<RandomEngine> other(engine.createStream(1, 0));
+
+    std::vector<qint64> expected(100);
+    std::vector<qint64> values(100);
+    std::vector<qint64> otherValues(100);
+    whole->fillBounded(1, 100, expected.data(), expected.size());
+    // second half first, as another thread would do it
+    static_cast<PhiloxEngine*>(chunks.get())->setDieIndex(50);
+    chunks->fillBounded(1, 100, values.data() + 50, 50);
+    static_cast<PhiloxEngine*>(chunks.get())->setDieIndex(0);
+    chunks->fillBounded(1, 100, values.data(), 50);
+    other->fillBounded(1, 100, otherValues.data(), otherValues.size());
+
+    QVERIFY(expected == values);
+    QVERIFY(expected != otherValues);
+
+    engine.seed(42);
+    qint64 first= 0;
+    whole->fillBounded(1, 100, &first, 1);
+    QCOMPARE(first, expected[0]);
+}
+
+void TestDice::philoxKnownAnswerTest()
+{
+    // Random123 kat_vectors, philox4x32 10 rounds, counter {0, 0, 0, 0} and key {0, 0}:
+    // 6627e8d5 e169c58d bc57ac4c 9b00dbd8
+    PhiloxEngine engine(0);
+    QCOMPARE(engine.next(), Q_UINT64_C(0xe169c58d6627e8d5));
+    QCOMPARE(engine.next(), Q_UINT64_C(0x9b00dbd8bc57ac4c));
+
+    std::unique_ptr<RandomEngine> stream(engine.createStream(0, 0));
+    QCOMPARE(stream->next(), Q_UINT64_C(0xe169c58d6627e8d5));
+}
+
+void TestDice::compactDiceTest()
+{
+    std::vector<qint64> values{3, 6, 1, 4};
+    DiceResult result;
+    result.setCompactResult(1, 6, Die::PLUS, values.data(), values.size());
+    QCOMPARE(result.diceCount(), 4);
+    QCOMPARE(result.getResult(Dice::RESULT_TYPE::SCALAR).toInt(), 14);
+
+    QList<quint64> ids;
+    int i= 0;
+    for(const auto& die : result.view())
+    {
+        QCOMPARE(die.getValue(), values[static_cast<std::size_t>(i)]);
+        QCOMPARE(die.getFaces(), quint64(6));
+        QVERIFY(die.isHighlighted());
+        QVERIFY(!die.isSelected());
+        ids << die.getUuid();
+        ++i;
+    }
+    QCOMPARE(i, 4);
+
+    auto copy= std::unique_ptr<Result>(result.getCopy());
+    auto copyResult= dynamic_cast<DiceResult*>(copy.get());
+    QVERIFY(nullptr != copyResult);
+    QCOMPARE(copyResult->getResult(Dice::RESULT_TYPE::SCALAR).toInt(), 14);
+
+    auto list= result.getResultList();
+    QCOMPARE(list.size(), 4);
+    for(int j= 0; j < list.size(); ++j)
+    {
+        QCOMPARE(list[j]->getValue(), values[static_cast<std::size_t>(j)]);
+        QCOMPARE(list[j]->getUuid(), ids[j]);
+    }
+    QCOMPARE(result.diceCount(), 4);
+
+    CompactDiceList compact;
+    compact.assign(1, 10, Die::PLUS, values.data(), values.size());
+    compact.appendRoll(1, 10);
+    compact.appendRoll(1, 2);
+    compact.setColor(2, "red");
+    QCOMPARE(compact.value(1), qint64(18));
+    QCOMPARE(compact.rolls(1), QList<qint64>({6, 10, 2}));
+    std::unique_ptr<Die> die(compact.createDie(1));
+    QCOMPARE(die->getValue(), qint64(18));
+    QCOMPARE(compact.color(2), QStringLiteral("red"));
+    QVERIFY(compact.color(0).isEmpty());
+}
+
+void TestDice::histogramTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(bool, histogram);
+    QFETCH(int, min);
+    QFETCH(int, max);
+
+    ParsingToolBox parsingToolbox;
+    std::shared_ptr<RandomEngine> engine(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    engine->seed(7);
+    parsingToolbox.setRandomEngine(engine);
+    auto instructions= parsingToolbox.readInstructionList(cmd, true);
+    QCOMPARE(static_cast<int>(instructions.size()), 1);
+    auto start= instructions.front();
+    // the histogram is rolled by the node, the program does not take it.
+    if(histogram)
+        QVERIFY(!DiceProgram::compile(start).isValid());
+
+    start->run(nullptr);
+    DiceRollerNode* roller= nullptr;
+    for(auto node= start; nullptr == roller && nullptr != node; node= node->getNextNode())
+        roller= dynamic_cast<DiceRollerNode*>(node);
+    QVERIFY(nullptr != roller);
+    auto dice= dynamic_cast<DiceResult*>(roller->getResult());
+    QVERIFY(nullptr != dice);
+    QCOMPARE(nullptr != dice->histogram(), histogram);
+
+    auto leaf= ParsingToolBox::getLeafNode(start);
+    if(leaf->getResult()->hasResultOfType(Dice::RESULT_TYPE::SCALAR))
+    {
+        auto value= leaf->getResult()->getResult(Dice::RESULT_TYPE::SCALAR).toInt();
+        QVERIFY2(value >= min && value <= max, qPrintable(QString::number(value)));
+    }
+
+    // the dice built from a histogram give the same sum and the same highlighted dice.
+    auto sum= dice->getResult(Dice::RESULT_TYPE::SCALAR).toInt();
+    auto count= dice->diceCount();
+    int highlighted= 0;
+    for(const auto& die : dice->view())
+        highlighted+= die.isHighlighted() ? 1 : 0;
+    auto list= dice->getResultList();
+    QCOMPARE(list.size(), count);
+    int listSum= 0;
+    int listHighlighted= 0;
+    for(auto die : list)
+    {
+        listSum+= static_cast<int>(die->getValue());
+        listHighlighted+= die->isHighlighted() ? 1 : 0;
+    }
+    QCOMPARE(listSum, sum);
+    QCOMPARE(listHighlighted, highlighted);
+}
+
+void TestDice::histogramTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<bool>("histogram");
+    QTest::addColumn<int>("min");
+    QTest::addColumn<int>("max");
+
+    QTest::addRow("cmd1") << "100000d10c[>=7]" << true << 28000 << 32000;
+    QTest::addRow("cmd2") << "5000d6o" << true << 0 << 0;
+    QTest::addRow("cmd3") << "4000d6" << false << 13000 << 15000;
+    QTest::addRow("cmd4") << "2000d10k10" << true << 100 << 100;
+    QTest::addRow("cmd5") << "2000d6s" << false << 6500 << 7500;
+    QTest::addRow("cmd6") << "1500d6+3" << true << 4800 << 5700;
+    QTest::addRow("cmd7") << "100d10c[>=7]" << false << 0 << 100;
+    QTest::addRow("cmd8") << "3000d1000c[>=7]" << false << 0 << 3000;
+    QTest::addRow("cmd9") << "2000d10c[:>100]" << false << 10000 << 12000;
+    QTest::addRow("cmd10") << "2000d10c[.=10]" << true << 10000 << 12000;
+    QTest::addRow("cmd11") << "2000d10e10" << false << 2000 << 40000;
+    QTest::addRow("cmd12") << "2000d6s+0" << true << 6500 << 7500;
+    QTest::addRow("cmd13") << "2000d10k10s" << true << 100 << 100;
+}
+
+void TestDice::histogramOrderTest()
+{
+    // a pool read as it is keeps the order of its rolls
+    ParsingToolBox parsingToolbox;
+    std::shared_ptr<RandomEngine> engine(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    engine->seed(5);
+    parsingToolbox.setRandomEngine(engine);
+    QString cmd("2000d6");
+    auto instructions= parsingToolbox.readInstructionList(cmd, true);
+    QCOMPARE(static_cast<int>(instructions.size()), 1);
+    auto start= instructions.front();
+    start->run(nullptr);
+
+    auto dice= Result::asDice(ParsingToolBox::getLeafNode(start)->getResult());
+    QVERIFY(nullptr != dice);
+    QVERIFY(nullptr == dice->histogram());
+
+    std::unique_ptr<RandomEngine> reference(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    reference->seed(5);
+    std::vector<qint64> expected(2000);
+    reference->fillBounded(1, 6, expected.data(), expected.size());
+    std::vector<qint64> values;
+    for(const auto& die : dice->view())
+        values.push_back(die.getValue());
+    QVERIFY(values == expected);
+}
+
+void TestDice::histogramDisplayTest()
+{
+    QFETCH(QString, cmd);
+
+    // the output of a seeded run does not change between runs
+    QStringList outputs;
+    for(int i= 0; i < 2; ++i)
+    {
+        DiceParser parser;
+        parser.setRandomEngine(Dice::RANDOM_ENGINE::XOSHIRO256);
+        parser.setSeed(9);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        outputs << rollOutput(parser);
+    }
+    QCOMPARE(outputs[1], outputs[0]);
+
+    ParsingToolBox parsingToolbox;
+    std::shared_ptr<RandomEngine> engine(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    engine->seed(9);
+    parsingToolbox.setRandomEngine(engine);
+    auto instructions= parsingToolbox.readInstructionList(cmd, true);
+    QCOMPARE(static_cast<int>(instructions.size()), 1);
+    auto start= instructions.front();
+    start->run(nullptr);
+    DiceRollerNode* roller= nullptr;
+    for(auto node= start; nullptr == roller && nullptr != node; node= node->getNextNode())
+        roller= dynamic_cast<DiceRollerNode*>(node);
+    QVERIFY(nullptr != roller);
+    auto dice= Result::asDice(roller->getResult());
+    QVERIFY(nullptr != dice);
+    QVERIFY(nullptr != dice->histogram());
+
+    // shown die by die, the histogram is in a roll order: grouped by face, 2000d6 changes value 5 times at most.
+    std::vector<qint64> shown;
+    for(const auto& die : dice->view())
+        shown.push_back(die.getValue());
+    QCOMPARE(static_cast<int>(shown.size()), 2000);
+    int changes= 0;
+    for(std::size_t i= 1; i < shown.size(); ++i)
+        changes+= shown[i] != shown[i - 1] ? 1 : 0;
+    QVERIFY2(changes > 1000, qPrintable(QString::number(changes)));
+
+    // dice built from the histogram keep that order
+    auto list= dice->getResultList();
+    QCOMPARE(list.size(), 2000);
+    for(int i= 0; i < list.size(); ++i)
+        QCOMPARE(list[i]->getValue(), shown[static_cast<std::size_t>(i)]);
+}
+
+void TestDice::histogramDisplayTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+
+    QTest::addRow("cmd1") << "2000d6+5";
+    QTest::addRow("cmd2") << "2000d6c[>3]";
+}
+
+void TestDice::dieSharingTest()
+{
+    Die die;
+    die.setBase(1);
+    die.setMaxValue(10);
+    die.insertRollValue(4);
+    die.setColor("red");
+
+    Die copy(die);
+    QCOMPARE(copy.getUuid(), die.getUuid());
+    QCOMPARE(copy.getValue(), qint64(4));
+    QCOMPARE(copy.getFaces(), quint64(10));
+
+    // flags and color belong to each copy.
+    copy.setHighlighted(false);
+    copy.displayed();
+    copy.setColor("blue");
+    QVERIFY(die.isHighlighted());
+    QVERIFY(!die.hasBeenDisplayed());
+    QCOMPARE(die.getColor(), QStringLiteral("red"));
+
+    // rolls are shared until one copy changes them.
+    copy.insertRollValue(10);
+    QCOMPARE(copy.getListValue(), QList<qint64>({4, 10}));
+    QCOMPARE(die.getListValue(), QList<qint64>({4}));
+    QCOMPARE(die.getValue(), qint64(4));
+    QCOMPARE(copy.getValue(), qint64(14));
+
+    Die third(copy);
+    third.replaceLastValue(2);
+    third.setOp(Die::MULTIPLICATION);
+    QCOMPARE(third.getValue(), qint64(8));
+    QCOMPARE(copy.getValue(), qint64(14));
+    QCOMPARE(copy.getOp(), Die::PLUS);
+
+    Die fourth(die);
+    fourth.setValue(9);
+    fourth.setUuid(die.getUuid() + 1);
+    QCOMPARE(die.getValue(), qint64(4));
+    QCOMPARE(fourth.getValue(), qint64(9));
+    QVERIFY(fourth.getUuid() != die.getUuid());
+}
+
+void TestDice::dieValueTest()
+{
+    m_die->setMaxValue(10);
+    m_die->insertRollValue(10);
+    m_die->insertRollValue(10);
+    m_die->insertRollValue(3);
+    QCOMPARE(m_die->getValue(), qint64(23));
+
+    m_die->replaceLastValue(5);
+    QCOMPARE(m_die->getValue(), qint64(25));
+
+    m_die->setOp(Die::MULTIPLICATION);
+    QCOMPARE(m_die->getValue(), qint64(500));
+
+    Die copy(*m_die);
+    QCOMPARE(copy.getValue(), qint64(500));
+
+    m_die->setValue(7);
+    QCOMPARE(m_die->getValue(), qint64(7));
+}
+
+void TestDice::explodeSortBenchmark()
+{
+    m_diceParser->setRandomEngine(Dice::RANDOM_ENGINE::XOSHIRO256);
+    m_diceParser->setSeed(20);
+    QBENCHMARK
+    {
+        QVERIFY(m_diceParser->parseLine("20d10e10s"));
+        m_diceParser->start();
+        auto results= m_diceParser->scalarResultsFromEachInstruction();
+        QVERIFY(!results.isEmpty());
+    }
+}
+
+void TestDice::resultKindBenchmark()
+{
+    QFETCH(QString, mode);
+
+    // 17 operators: rolls, explode, reroll, sorts, keeps, count, filter and arithmetic.
+    QString cmd("20d10e10r1sk10c[>=3]+4d6e6f[!=4]+2d10k1-1d6e6*2");
+    ParsingToolBox parsingToolbox;
+    std::shared_ptr<RandomEngine> engine(RandomEngine::create(Dice::RANDOM_ENGINE::XOSHIRO256));
+    engine->seed(20);
+    parsingToolbox.setRandomEngine(engine);
+    auto instructions= parsingToolbox.readInstructionList(cmd, true);
+    QCOMPARE(static_cast<int>(instructions.size()), 1);
+    auto start= instructions.front();
+    start->run(nullptr);
+
+    std::vector<Result*> results;
+    std::function<void(ExecutionNode*)> collect= [&results, &collect](ExecutionNode* node) {
+        for(; nullptr != node; node= node->getNextNode())
+        {
+            results.push_back(node->getResult());
+            if(auto scalar= dynamic_cast<ScalarOperatorNode*>(node))
+                collect(scalar->getInternalNode());
+        }
+    };
+    collect(start);
+    QVERIFY(results.size() >= 15);
+
+    int expected= 0;
+    for(auto result : results)
+    {
+        QCOMPARE(Result::asDice(result), dynamic_cast<DiceResult*>(result));
+        QCOMPARE(Result::asScalar(result), dynamic_cast<ScalarResult*>(result));
+        QCOMPARE(Result::asString(result), dynamic_cast<StringResult*>(result));
+        expected+= nullptr != Result::asDice(result) ? 1 : 0;
+    }
+
+    if(mode == QStringLiteral("tree"))
+    {
+        QBENCHMARK
+        {
+            start->run(nullptr);
+        }
+    }
+    else
+    {
+        const bool kind= mode == QStringLiteral("kind");
+        int found= 0;
+        QBENCHMARK
+        {
+            found= 0;
+            for(auto result : results)
+            {
+                auto dice= kind ? Result::asDice(result) : dynamic_cast<DiceResult*>(result);
+                found+= nullptr != dice ? 1 : 0;
+            }
+        }
+        QCOMPARE(found, expected);
+    }
+}
+
+void TestDice::resultKindBenchmark_data()
+{
+    QTest::addColumn<QString>("mode");
+
+    QTest::addRow("tree") << "tree";
+    QTest::addRow("dynamic_cast") << "dynamic_cast";
+    QTest::addRow("kind") << "kind";
+}
+
+void TestDice::repeatTurnBenchmark()
+{
+    QFETCH(QString, mode);
+
+    // each turn of repeat() reseeds its stream, then rolls 1d20.
+    if(mode == QStringLiteral("repeat"))
+    {
+        DiceParser parser;
+        parser.setSeed(20);
+        QVERIFY(parser.parseLine("repeat(1d20,10000)"));
+        QBENCHMARK
+        {
+            parser.start();
+        }
+        QVERIFY(parser.humanReadableError().isEmpty());
+        return;
+    }
+
+    std::unique_ptr<RandomEngine> engine;
+    if(mode == QStringLiteral("mt19937"))
+        engine.reset(new MersenneTwisterEngine(20));
+    else
+        engine.reset(new Xoshiro256Engine(20));
+    qint64 sum= 0;
+    QBENCHMARK
+    {
+        for(quint64 turn= 0; turn < 10000; ++turn)
+        {
+            engine->seed(RandomEngine::streamSeed(20, turn));
+            sum+= engine->bounded(1, 20);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void TestDice::repeatTurnBenchmark_data()
+{
+    QTest::addColumn<QString>("mode");
+
+    QTest::addRow("mt19937") << "mt19937";
+    QTest::addRow("xoshiro256") << "xoshiro256";
+    QTest::addRow("repeat") << "repeat";
+}
+
+void TestDice::rollTapeTest()
+{
+    const QString cmd("20d10e10r1s;3L[a,b,c]");
+
+    m_diceParser->startRecording();
+    QVERIFY(m_diceParser->parseLine(cmd));
+    m_diceParser->start();
+    auto recorded= rollOutput(*m_diceParser);
+    auto tape= m_diceParser->rollTape();
+    QVERIFY(!tape.draws.empty());
+
+    m_diceParser->startReplay(tape);
+    for(int i= 0; i < 3; ++i)
+    {
+        QVERIFY(m_diceParser->parseLine(cmd));
+        m_diceParser->start();
+        QCOMPARE(rollOutput(*m_diceParser), recorded);
+        QVERIFY(!m_diceParser->isReplayExhausted());
+    }
+
+    m_diceParser->stopRollTape();
+    QVERIFY(m_diceParser->rollTape().draws.empty());
+}
+
+void TestDice::preparedCommandTest()
+{
+    auto prepared= m_diceParser->prepare("20d10e10r1s;3L[a,b,c]");
+    QVERIFY(prepared.isValid());
+    QCOMPARE(prepared.instructionCount(), 2);
+
+    m_diceParser->setSeed(42);
+    QVERIFY(m_diceParser->start(prepared));
+    auto first= rollOutput(*m_diceParser);
+
+    m_diceParser->setSeed(42);
+    QVERIFY(m_diceParser->start(prepared));
+    QCOMPARE(rollOutput(*m_diceParser), first);
+
+    DiceParser other;
+    other.setSeed(42);
+    QVERIFY(other.start(prepared));
+    QCOMPARE(rollOutput(other), first);
+
+    // instructions refer to the results of their own run
+    auto variable= m_diceParser->prepare("1d100;$1+1000");
+    for(int i= 0; i < 50; ++i)
+    {
+        QVERIFY(m_diceParser->start(variable));
+        auto results= m_diceParser->scalarResultsFromEachInstruction();
+        QCOMPARE(results.size(), 2);
+        QCOMPARE(results[1], results[0] + 1000);
+    }
+
+    auto threeDice= m_diceParser->prepare("3d6");
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for(int t= 0; t < 4; ++t)
+    {
+        threads.emplace_back([&threeDice, &failures]() {
+            DiceParser parser;
+            for(int i= 0; i < 200; ++i)
+            {
+                auto ok= parser.start(threeDice);
+                auto results= parser.scalarResultsFromEachInstruction();
+                if(!ok || results.size() != 1 || results[0] < 3 || results[0] > 18)
+                    ++failures;
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+    QCOMPARE(failures.load(), 0);
+
+    auto wrong= m_diceParser->prepare("1D10e[>0]");
+    QVERIFY(!wrong.isValid());
+    QVERIFY(!m_diceParser->start(wrong));
+
+    // a plan runs as the parsed command, whatever its operators hold
+    for(auto cmd : {"4du6", "5d10o", "repeat(1d6,3)", "[1,2,3]k2", "4d6t+1", "3d6p[1:blue]", "3d6c[:>10]"})
+    {
+        DiceParser parser;
+        parser.setSeed(7);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        auto expected= rollOutput(parser);
+
+        auto plan= parser.prepare(cmd);
+        QVERIFY2(plan.isValid(), cmd);
+        for(int i= 0; i < 2; ++i)
+        {
+            parser.setSeed(7);
+            QVERIFY(parser.start(plan));
+            QCOMPARE(rollOutput(parser), expected);
+        }
+    }
+
+    auto unique= m_diceParser->prepare("4du6");
+    for(int i= 0; i < 50; ++i)
+    {
+        QVERIFY(m_diceParser->start(unique));
+        QList<ExportedDiceResult> dice;
+        m_diceParser->diceResultFromEachInstruction(dice);
+        QSet<qint64> values;
+        for(auto const& lists : dice.first())
+            for(auto const& list : lists)
+                for(auto const& die : list)
+                    values.insert(die.result().first());
+        QCOMPARE(values.size(), 4);
+    }
+}
+
+void TestDice::planCacheTest()
+{
+    DiceParser parser;
+    parser.setPlanCacheSize(2);
+
+    for(auto cmd : {"2D6", "2d6", "2d6"})
+    {
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        auto results= parser.scalarResultsFromEachInstruction();
+        QCOMPARE(results.size(), 1);
+        QVERIFY(results[0] >= 2 && results[0] <= 12);
+        QVERIFY(parser.humanReadableWarning().isEmpty());
+        // the command shown is the one given, not the one which filled the cache
+        QCOMPARE(parser.diceCommand(), QString(cmd));
+    }
+    QCOMPARE(parser.cachedPlanCount(), 1);
+    DiceParser uncached;
+    QVERIFY(uncached.parseLine("2D6 #attack"));
+    QVERIFY(parser.parseLine("2d6 #attack"));
+    QVERIFY(parser.parseLine("2D6 #attack"));
+    QCOMPARE(parser.diceCommand(), uncached.diceCommand());
+    QCOMPARE(parser.comment(), uncached.comment());
+
+    QVERIFY(parser.parseLine("1d20"));
+    QVERIFY(parser.parseLine("8d10e10k4"));
+    QCOMPARE(parser.cachedPlanCount(), 2);
+
+    QVERIFY(!parser.parseLine("1D10e[>0]"));
+    QVERIFY(!parser.parseLine("1D10e[>0]"));
+    QCOMPARE(parser.cachedPlanCount(), 2);
+
+    QCOMPARE(PreparedCommandCache::normalize("3D6+1L[D,d];\"D\"#Deal"), QString("3d6+1L[D,d];\"D\"#Deal"));
+
+    // a cache hit runs as the parse which filled the cache
+    for(auto cmd : {"4du6", "5d10o", "repeat(1d6,3)", "[1,2,3]k2", "4d6t+1", "3d6p[1:blue]"})
+    {
+        DiceParser cached;
+        cached.setPlanCacheSize(4);
+        QStringList outputs;
+        for(int i= 0; i < 3; ++i)
+        {
+            cached.setSeed(11);
+            QVERIFY(cached.parseLine(cmd));
+            cached.start();
+            outputs << rollOutput(cached);
+        }
+        QCOMPARE(cached.cachedPlanCount(), 1);
+        QCOMPARE(outputs[1], outputs[0]);
+        QCOMPARE(outputs[2], outputs[0]);
+    }
+
+    // variables are read while parsing
+    parser.setVariableDictionary({{"level", "3"}});
+    QVERIFY(parser.parseLine("${level}d1"));
+    parser.start();
+    QCOMPARE(parser.scalarResultsFromEachInstruction(), QList<qreal>({3}));
+    parser.setVariableDictionary({{"level", "5"}});
+    QVERIFY(parser.parseLine("${level}d1"));
+    parser.start();
+    QCOMPARE(parser.scalarResultsFromEachInstruction(), QList<qreal>({5}));
+    parser.setVariableDictionary({});
+
+    parser.setPlanCacheSize(0);
+    QCOMPARE(parser.cachedPlanCount(), 0);
+}
+
+void TestDice::arenaAllocationTest()
+{
+    QFETCH(QString, cmd);
+
+    DiceParser heapParser;
+    heapParser.setArenaEnabled(false);
+    auto before= DiceArena::heapAllocationCount();
+    heapParser.parseLine(cmd);
+    heapParser.start();
+    auto withoutArena= DiceArena::heapAllocationCount() - before;
+
+    DiceParser arenaParser;
+    before= DiceArena::heapAllocationCount();
+    arenaParser.parseLine(cmd);
+    arenaParser.start();
+    arenaParser.parseLine(cmd);
+    arenaParser.start();
+    auto withArena= DiceArena::heapAllocationCount() - before;
+
+    qInfo() << cmd << "- nodes, results and dice allocated on the heap:" << withoutArena << "without arena,"
+            << withArena << "with arena";
+    QCOMPARE(withArena, quint64(0));
+    QCOMPARE(arenaParser.humanReadableError(), heapParser.humanReadableError());
+}
+
+void TestDice::arenaAllocationTest_data()
+{
+    commandsTest_data();
+}
+
+void TestDice::bytecodeTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(int, compiled);
+
+    auto identity= [](const QString& result, const QString&, bool) { return result; };
+    for(quint64 seed : {1u, 7u, 42u})
+    {
+        DiceParser tree;
+        tree.setSeed(seed);
+        QVERIFY(tree.parseLine(cmd));
+        tree.start();
+
+        DiceParser bytecode;
+        bytecode.setBytecodeEnabled(true);
+        bytecode.setSeed(seed);
+        QVERIFY(bytecode.parseLine(cmd));
+        bytecode.start();
+
+        QCOMPARE(bytecode.compiledInstructionCount(), compiled);
+        QCOMPARE(bytecode.scalarResultsFromEachInstruction(), tree.scalarResultsFromEachInstruction());
+        QCOMPARE(rollOutput(bytecode), rollOutput(tree));
+        QCOMPARE(bytecode.finalStringResult(identity), tree.finalStringResult(identity));
+        QCOMPARE(bytecode.humanReadableError(), tree.humanReadableError());
+    }
+}
+
+void TestDice::bytecodeTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<int>("compiled");
+
+    QTest::addRow("cmd1") << "3d6" << 1;
+    QTest::addRow("cmd2") << "4d6k3" << 1;
+    QTest::addRow("cmd3") << "4d6kl2" << 1;
+    QTest::addRow("cmd4") << "10d6s" << 1;
+    QTest::addRow("cmd5") << "10d10e10" << 1;
+    QTest::addRow("cmd6") << "10d10c[>7]" << 1;
+    QTest::addRow("cmd7") << "20d10e[>=9]sc[>=6]" << 1;
+    QTest::addRow("cmd8") << "8d6e6k3" << 1;
+    QTest::addRow("cmd9") << "1D8+2D6+7" << 1;
+    QTest::addRow("cmd10") << "2d6*3-1" << 1;
+    QTest::addRow("cmd11") << "3d6|2" << 1;
+    QTest::addRow("cmd12") << "1d20/0" << 1;
+    QTest::addRow("cmd13") << "3d6k5" << 1;
+    QTest::addRow("cmd14") << "3d6;4d10k2;2d20" << 3;
+    QTest::addRow("cmd15") << "15D10e10c[8..10]" << 0;
+    QTest::addRow("cmd16") << "1d100;$1+1000" << 1;
+    QTest::addRow("cmd17") << "(4D6)D10" << 0;
+}
+
+void TestDice::executionBudgetTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(int, maxDice);
+    QFETCH(int, maxRolls);
+    QFETCH(int, maxDuration);
+    QFETCH(int, status);
+
+    for(bool bytecode : {false, true})
+    {
+        DiceParser parser;
+        parser.setBytecodeEnabled(bytecode);
+        parser.executionBudget().setMaxDice(static_cast<quint64>(maxDice));
+        parser.executionBudget().setMaxRolls(static_cast<quint64>(maxRolls));
+        parser.executionBudget().setMaxDuration(maxDuration);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+
+        auto expected= static_cast<ExecutionBudget::Status>(status);
+        QCOMPARE(parser.executionBudget().status(), expected);
+        QCOMPARE(parser.errorMap().contains(Dice::ERROR_CODE::EXECUTION_BUDGET_EXCEEDED),
+                 expected != ExecutionBudget::Status::Running);
+    }
+}
+
+void TestDice::executionBudgetTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<int>("maxDice");
+    QTest::addColumn<int>("maxRolls");
+    QTest::addColumn<int>("maxDuration");
+    QTest::addColumn<int>("status");
+
+    auto running= static_cast<int>(ExecutionBudget::Status::Running);
+    auto dice= static_cast<int>(ExecutionBudget::Status::TooManyDice);
+    auto rolls= static_cast<int>(ExecutionBudget::Status::TooManyRolls);
+    auto timeOut= static_cast<int>(ExecutionBudget::Status::TimeOut);
+
+    QTest::addRow("cmd1") << "3d6" << 0 << 0 << 0 << running;
+    QTest::addRow("cmd2") << "3d6+4d10" << 7 << 7 << 1000 << running;
+    QTest::addRow("cmd3") << "1000000d6" << 1000 << 0 << 0 << dice;
+    QTest::addRow("cmd4") << "1000d6" << 0 << 100 << 0 << rolls;
+    QTest::addRow("cmd5") << "100d10e[>1]" << 0 << 150 << 0 << rolls;
+    QTest::addRow("cmd6") << "3d6;1000d6" << 0 << 100 << 0 << rolls;
+    QTest::addRow("cmd7") << "2d1t" << 0 << 0 << 50 << timeOut;
+}
+
+void TestDice::poolSizeLimitTest()
+{
+    QFETCH(QString, cmd);
+
+    // refused before the pool is allocated, even without any budget.
+    for(bool bytecode : {false, true})
+    {
+        DiceParser parser;
+        parser.setBytecodeEnabled(bytecode);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        QVERIFY(parser.errorMap().contains(Dice::ERROR_CODE::TOO_MANY_DICE));
+    }
+}
+
+void TestDice::poolSizeLimitTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+
+    QTest::addRow("cmd1") << "99999999999d6";
+    QTest::addRow("cmd2") << "1000001d6";
+    QTest::addRow("cmd3") << "3d6;99999999999d10s";
+    QTest::addRow("cmd4") << "(99999999999*99999999999)d6";
+    QTest::addRow("cmd5") << "99999999999d6c[>3]";
+}
+
+void TestDice::executionCancelTest()
+{
+    DiceParser parser;
+    QVERIFY(parser.parseLine("2d1t"));
+
+    // a single cancel, whether it comes before start() or while it runs
+    std::thread canceller([&parser]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        parser.executionBudget().cancel();
+    });
+    parser.start();
+    canceller.join();
+
+    QCOMPARE(parser.executionBudget().status(), ExecutionBudget::Status::Cancelled);
+    QVERIFY(parser.errorMap().contains(Dice::ERROR_CODE::EXECUTION_CANCELLED));
+
+    // the cancellation lasts until it is cleared
+    QVERIFY(parser.parseLine("2d6"));
+    parser.start();
+    QCOMPARE(parser.executionBudget().status(), ExecutionBudget::Status::Cancelled);
+    parser.executionBudget().clearCancel();
+    parser.start();
+    QCOMPARE(parser.executionBudget().status(), ExecutionBudget::Status::Running);
+    QVERIFY(!parser.errorMap().contains(Dice::ERROR_CODE::EXECUTION_CANCELLED));
+}
+
+void TestDice::costEstimateTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(qreal, dice);
+    QFETCH(qreal, output);
+    QFETCH(bool, endless);
+
+    DiceParser parser;
+    QVERIFY(parser.parseLine(cmd));
+    auto cost= parser.estimateCost();
+
+    QCOMPARE(cost.isEndless(), endless);
+    QCOMPARE(cost.dice().worst, dice);
+    QCOMPARE(cost.output().worst, output);
+    QVERIFY(cost.dice().expected <= cost.dice().worst);
+    QVERIFY(cost.rolls().expected <= cost.rolls().worst);
+    QVERIFY(cost.iterations().expected <= cost.iterations().worst);
+    QVERIFY(cost.rolls().expected >= cost.dice().expected || cost.dice().expected == 0.0);
+
+    ExecutionBudget budget;
+    budget.setMaxDice(100);
+    QCOMPARE(cost.fits(budget), !endless && dice <= 100.0);
+}
+
+void TestDice::costEstimateTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<qreal>("dice");
+    QTest::addColumn<qreal>("output");
+    QTest::addColumn<bool>("endless");
+
+    QTest::addRow("cmd1") << "3d6" << 3.0 << 3.0 << false;
+    QTest::addRow("cmd2") << "4d6k3" << 4.0 << 3.0 << false;
+    QTest::addRow("cmd3") << "1000000d6" << 1000000.0 << 1000000.0 << false;
+    QTest::addRow("cmd4") << "10d10e10" << 10.0 << 10.0 << false;
+    QTest::addRow("cmd5") << "10d10c[>7]" << 10.0 << 1.0 << false;
+    QTest::addRow("cmd6") << "3d6;$1d6" << 21.0 << 21.0 << false;
+    QTest::addRow("cmd7") << "(4D6)D10" << 28.0 << 24.0 << false;
+    QTest::addRow("cmd8") << "2d1t" << 2.0 << 2.0 << true;
+    QTest::addRow("cmd9") << "repeat(3d6,10)" << 30.0 << 30.0 << false;
+    QTest::addRow("cmd10") << "8d10r[<3]" << 8.0 << 8.0 << false;
+    QTest::addRow("cmd11") << "1d6+2d10+3" << 3.0 << 1.0 << false;
+}
+
+void TestDice::repeatTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(int, lines);
+    QFETCH(int, min);
+    QFETCH(int, max);
+
+    DiceParser parser;
+    parser.setSeed(42);
+    QVERIFY(parser.parseLine(cmd));
+    parser.start();
+    QVERIFY2(parser.humanReadableError().isEmpty(), "no error");
+
+    auto text= parser.finalStringResult([](const QString& result, const QString&, bool) { return result; });
+    auto values= text.split('\n');
+    QCOMPARE(values.size(), lines);
+    for(auto const& value : values)
+    {
+        bool ok= false;
+        auto number= value.toInt(&ok);
+        QVERIFY2(ok, value.toLocal8Bit());
+        QVERIFY(number >= min && number <= max);
+    }
+}
+
+void TestDice::repeatTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<int>("lines");
+    QTest::addColumn<int>("min");
+    QTest::addColumn<int>("max");
+
+    QTest::addRow("cmd1") << "repeat(1d20,1000)" << 1000 << 1 << 20;
+    QTest::addRow("cmd2") << "repeat(4d6k3,20)" << 20 << 3 << 18;
+    QTest::addRow("cmd3") << "repeat(3d6,100+)" << 1 << 300 << 1800;
+    QTest::addRow("cmd4") << "repeat(2d6+3,50+)" << 1 << 250 << 750;
+}
+
+void TestDice::parallelRepeatTest()
+{
+    QFETCH(QString, cmd);
+
+    auto identity= [](const QString& result, const QString&, bool) { return result; };
+    auto pool= QThreadPool::globalInstance();
+    auto threads= pool->maxThreadCount();
+    QStringList outputs;
+    for(int count : {1, 4})
+    {
+        pool->setMaxThreadCount(count);
+        DiceParser parser;
+        parser.setSeed(7);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        QVERIFY2(parser.humanReadableError().isEmpty(), "no error");
+        outputs << parser.finalStringResult(identity);
+    }
+    pool->setMaxThreadCount(threads);
+
+    QCOMPARE(outputs[1], outputs[0]);
+}
+
+void TestDice::parallelRepeatTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+
+    QTest::addRow("cmd1") << "repeat(1d20,1000)";
+    QTest::addRow("cmd2") << "repeat(4d6k3,200)";
+    QTest::addRow("cmd3") << "repeat(3d6e6,500+)";
+    QTest::addRow("cmd4") << "repeat(10d10c[>7],300+)";
+    QTest::addRow("cmd5") << "3d6;repeat($1+1d6,100)";
+    QTest::addRow("cmd6") << "3d6;repeat(4d10c[>$1],100+)";
+}
+
+void TestDice::instructionScheduleTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(bool, streams);
+    QFETCH(int, levels);
+
+    ParsingToolBox parsingToolbox;
+    std::shared_ptr<RandomEngine> engine(
+        RandomEngine::create(streams ? Dice::RANDOM_ENGINE::PHILOX : Dice::RANDOM_ENGINE::MT19937));
+    parsingToolbox.setRandomEngine(engine);
+    auto instructions= parsingToolbox.readInstructionList(cmd, true);
+    QVERIFY(!instructions.empty());
+
+    auto schedule= InstructionSchedule::analyse(instructions);
+    QCOMPARE(static_cast<int>(schedule.levels().size()), levels);
+    for(std::size_t i= 0; i < instructions.size(); ++i)
+    {
+        for(auto dependency : schedule.dependencies(i))
+            QVERIFY(dependency < i);
+    }
+}
+
+void TestDice::instructionScheduleTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<bool>("streams");
+    QTest::addColumn<int>("levels");
+
+    QTest::addRow("cmd1") << "1d20;2d10;3d8" << true << 1;
+    QTest::addRow("cmd2") << "1d20;2d10;3d8" << false << 3;
+    QTest::addRow("cmd3") << "100;200;300;[$1,$2,$3]k2" << true << 2;
+    QTest::addRow("cmd4") << "3d6;$1+2;4d10;$1*2" << true << 3;
+    QTest::addRow("cmd5") << "1d6e6;1d4e4mk1" << true << 2;
+    QTest::addRow("cmd6") << "10d10c[>=6]-@c[=1];2d6" << true << 1;
+    QTest::addRow("cmd7") << "repeat(1d6,3);repeat(2d6,3);1d8" << true << 2;
+    QTest::addRow("cmd8") << "1d20;[5,10,15]c[>$1]" << false << 2;
+    QTest::addRow("cmd9") << "1d20;[5,10,15]c[>$1]" << true << 2;
+    QTest::addRow("cmd10") << "4d10;2d10e[>$1];6d6r[<$1]" << true << 3;
+}
+
+void TestDice::parallelInstructionTest()
+{
+    QFETCH(QString, cmd);
+
+    auto identity= [](const QString& result, const QString&, bool) { return result; };
+    auto pool= QThreadPool::globalInstance();
+    auto threads= pool->maxThreadCount();
+    QStringList outputs;
+    QList<QList<qreal>> scalars;
+    for(int count : {1, 4})
+    {
+        pool->setMaxThreadCount(count);
+        DiceParser parser;
+        parser.setRandomEngine(Dice::RANDOM_ENGINE::PHILOX);
+        parser.setSeed(11);
+        QVERIFY(parser.parseLine(cmd));
+        parser.start();
+        QVERIFY2(parser.humanReadableError().isEmpty(), "no error");
+        outputs << parser.finalStringResult(identity);
+        scalars << parser.scalarResultsFromEachInstruction();
+    }
+    pool->setMaxThreadCount(threads);
+
+    QCOMPARE(outputs[1], outputs[0]);
+    QCOMPARE(scalars[1], scalars[0]);
+}
+
+void TestDice::parallelInstructionTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+
+    QTest::addRow("cmd1") << "1d20;2d10;3d8;4d6k3;10d10e10";
+    QTest::addRow("cmd2") << "3d6;$1+2;4d10;$1*2";
+    QTest::addRow("cmd3") << "8d10c[>6];8d10c[>6];8d10c[>6];[$1,$2,$3]k2";
+    QTest::addRow("cmd4") << "1d6e6;1d4e4mk1";
+    QTest::addRow("cmd5") << "repeat(3d6,20+);2d20;repeat(1d4,20+)";
+    QTest::addRow("cmd6") << "1d20;[5,10,15]c[>$1]";
+    QTest::addRow("cmd7") << "4d10;2d10c[>$1];3d10f[<$1]";
+}
+
+void TestDice::constantFoldingTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(bool, folded);
+
+    auto identity= [](const QString& result, const QString&, bool) { return result; };
+    DiceParser tree;
+    tree.setConstantFoldingEnabled(false);
+    tree.setSeed(5);
+    QVERIFY(tree.parseLine(cmd));
+    tree.start();
+    QCOMPARE(tree.foldedConstantCount(), 0);
+
+    DiceParser optimized;
+    optimized.setSeed(5);
+    QVERIFY(optimized.parseLine(cmd));
+    optimized.start();
+
+    QCOMPARE(optimized.foldedConstantCount() > 0, folded);
+    QCOMPARE(optimized.scalarResultsFromEachInstruction(), tree.scalarResultsFromEachInstruction());
+    QCOMPARE(rollOutput(optimized), rollOutput(tree));
+    QCOMPARE(optimized.finalStringResult(identity), tree.finalStringResult(identity));
+    QCOMPARE(optimized.humanReadableError(), tree.humanReadableError());
+}
+
+void TestDice::constantFoldingTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<bool>("folded");
+
+    QTest::addRow("cmd1") << "1+(4*3)D10" << true;
+    QTest::addRow("cmd2") << "(2+3)d6+4*2" << true;
+    QTest::addRow("cmd3") << "2+3*4" << true;
+    QTest::addRow("cmd4") << "3d6" << false;
+    QTest::addRow("cmd5") << "10/4" << false;
+    QTest::addRow("cmd6") << "8d10c[>=6]" << false;
+    QTest::addRow("cmd7") << "repeat((1+1)d6,5)" << true;
+    QTest::addRow("cmd8") << "3d6;(10-2)d10k3" << true;
+    QTest::addRow("cmd9") << "1d20i:[>10]{1+2}{3*4}" << true;
+    QTest::addRow("cmd10") << "1d20i:[>10]{(2+3)d6}{\"fail\"}" << true;
+    QTest::addRow("cmd11") << "4d6i[=6]{+2*3}" << true;
+}
+
+void TestDice::outputCacheTest()
+{
+    QFETCH(QString, cmd);
+    QFETCH(bool, pure);
+
+    auto identity= [](const QString& result, const QString&, bool) { return result; };
+    DiceParser parser;
+    parser.setOutputCacheSize(8);
+    QVERIFY(parser.cachedOutput(cmd, QStringLiteral("text")).isNull());
+
+    QVERIFY(parser.parseLine(cmd));
+    QCOMPARE(parser.isPure(), pure);
+    parser.start();
+    auto output= parser.finalStringResult(identity);
+    parser.storeOutput(QStringLiteral("text"), output);
+
+    QCOMPARE(parser.cachedOutputCount(), pure ? 1 : 0);
+    auto cached= parser.cachedOutput(cmd, QStringLiteral("text"));
+    QCOMPARE(cached.isNull(), !pure);
+    if(pure)
+        QCOMPARE(cached, output);
+    QVERIFY(parser.cachedOutput(cmd, QStringLiteral("json")).isNull());
+
+    parser.cleanAliases();
+    QCOMPARE(parser.cachedOutputCount(), 0);
+}
+
+void TestDice::outputCacheTest_data()
+{
+    QTest::addColumn<QString>("cmd");
+    QTest::addColumn<bool>("pure");
+
+    QTest::addRow("cmd1") << "2+3" << true;
+    QTest::addRow("cmd2") << "3d6" << false;
+    QTest::addRow("cmd3") << "[1,2,3]k2" << true;
+    QTest::addRow("cmd4") << "1d6+2" << false;
+    QTest::addRow("cmd5") << "4d6e6" << false;
+    QTest::addRow("cmd6") << "repeat(2+2,3)" << true;
+    QTest::addRow("cmd7") << "10/4;$1*2" << true;
+}
+
 void TestDice::commandEndlessLoop()
 {
     bool a= m_diceParser->parseLine("1D10e[>0]");
@@ -417,6 +1643,11 @@ void TestDice::rangedCommandsTest_data()
 
     QTest::addRow("cmd1") << "1L[5,6,7,8]+10" << 15 << 18;
     QTest::addRow("cmd2") << "2L[5,6,7,8]+10" << 20 << 26;
+    QTest::addRow("cmd3") << "6du6" << 21 << 21;
+    QTest::addRow("cmd4") << "100du100" << 5050 << 5050;
+    QTest::addRow("cmd5") << "3du[2..4]" << 9 << 9;
+    QTest::addRow("cmd6") << "10L[1[10],2[50],3[40]]" << 10 << 30;
+    QTest::addRow("cmd7") << "1L[2[1..3],4[5..6]]" << 2 << 4;
 }
 
 void TestDice::wrongCommandsTest()
@@ -120,6 +120,11 @@ qint64 Validator::validResult(const std::vector<Die*>& b, bool recursive, bool u
     return result;
 }
 
+bool Validator::dependsOnRollsOnly() const
+{
+    return false;
+}
+
 Dice::ConditionType Validator::getConditionType() const
 {
     return m_conditionType;
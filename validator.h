@@ -73,6 +73,12 @@ public:
      * @return
      */
     virtual const std::set<qint64>& getPossibleValues(const std::pair<qint64, qint64>& range);
+    /**
+     * @brief dependsOnRollsOnly
+     * @return true if the validity of a die only depends on its rolls: dice showing the same rolls always get the
+     * same answer.
+     */
+    virtual bool dependsOnRollsOnly() const;
     /**
      * @brief validResult
      * @param b
@@ -25,6 +25,7 @@
 #include "result/result.h"
 #include "validator.h"
 #include <QDebug>
+#include <algorithm>
 #include <utility>
 
 void mergeResultsAsAND(const ValidatorResult& diceList, ValidatorResult& result)
@@ -53,7 +54,7 @@ void mergeResultsAsExeclusiveOR(const ValidatorResult& diceList, ValidatorResult
 
 DiceResult* getDiceResult(Result* result)
 {
-    auto dice= dynamic_cast<DiceResult*>(result);
+    auto dice= Result::asDice(result);
     if(nullptr == dice)
     {
         qFatal("Error, no dice result");
@@ -266,17 +267,54 @@ Dice::CONDITION_STATE ValidatorList::isValidRangeSize(const std::pair<qint64, qi
     return val;
 }
 
+qreal ValidatorList::validProbability(const std::pair<qint64, qint64>& range) const
+{
+    // a thousand faces are enough to rank a command, larger dice are sampled at regular steps.
+    constexpr quint64 maxSamples= 1024;
+    auto state= isValidRangeSize(range);
+    if(Dice::CONDITION_STATE::ALWAYSTRUE == state)
+        return 1.0;
+    if(Dice::CONDITION_STATE::UNREACHABLE == state || range.second < range.first)
+        return 0.0;
+
+    auto faces= static_cast<quint64>(range.second - range.first) + 1;
+    auto step= std::max<quint64>(1, faces / maxSamples);
+    quint64 samples= 0;
+    quint64 valid= 0;
+    for(quint64 i= 0; i < faces; i+= step)
+    {
+        Die die;
+        die.setBase(range.first);
+        die.setMaxValue(range.second);
+        die.insertRollValue(range.first + static_cast<qint64>(i));
+        ++samples;
+        if(hasValid(&die, false))
+            ++valid;
+    }
+    return static_cast<qreal>(valid) / static_cast<qreal>(samples);
+}
+
 void ValidatorList::setOperationList(const QVector<LogicOperation>& m)
 {
     m_operators= m;
 }
 
+const QVector<ValidatorList::LogicOperation>& ValidatorList::getOperationList() const
+{
+    return m_operators;
+}
+
 void ValidatorList::setValidators(const QList<Validator*>& valids)
 {
     qDeleteAll(m_validatorList);
     m_validatorList= valids;
 }
 
+const QList<Validator*>& ValidatorList::getValidators() const
+{
+    return m_validatorList;
+}
+
 void ValidatorList::validResult(Result* result, bool recursive, bool unlight,
                                 std::function<void(Die*, qint64)> functor) const
 {
@@ -430,10 +468,22 @@ void ValidatorList::validResult(Result* result, bool recursive, bool unlight,
     }
 }
 
+bool ValidatorList::dependsOnRollsOnly() const
+{
+    // a condition on the sum of the dice can not be answered die by die.
+    return std::all_of(m_validatorList.begin(), m_validatorList.end(), [](Validator* validator) {
+        return validator->getConditionType() != Dice::OnScalar && validator->dependsOnRollsOnly();
+    });
+}
+
 ValidatorList* ValidatorList::getCopy() const
 {
     ValidatorList* val= new ValidatorList();
     val->setOperationList(m_operators);
-    val->setValidators(m_validatorList);
+    // validators own their value nodes: a copy has to own its own ones.
+    QList<Validator*> validators;
+    for(auto validator : m_validatorList)
+        validators.append(validator->getCopy());
+    val->setValidators(validators);
     return val;
 }
@@ -89,11 +89,23 @@ public:
     virtual qint64 hasValid(Die* b, bool recursive, bool unhighlight= false) const;
 
     void setOperationList(const QVector<LogicOperation>& m);
+    const QVector<LogicOperation>& getOperationList() const;
     void setValidators(const QList<Validator*>& valids);
+    const QList<Validator*>& getValidators() const;
 
     QString toString();
 
     virtual Dice::CONDITION_STATE isValidRangeSize(const std::pair<qint64, qint64>& range) const;
+    /**
+     * @brief validProbability
+     * @return share of the faces of a die in range which are valid, large ranges are sampled.
+     */
+    qreal validProbability(const std::pair<qint64, qint64>& range) const;
+    /**
+     * @brief dependsOnRollsOnly
+     * @return true if each die is checked alone and its validity only depends on its rolls.
+     */
+    bool dependsOnRollsOnly() const;
 
     virtual ValidatorList* getCopy() const;
 
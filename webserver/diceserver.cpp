@@ -10,6 +10,7 @@ DiceServer::DiceServer(int port) : QObject(), m_diceParser(new DiceParser())
 {
     m_diceParser->setPathToHelp(
         "<span><a href=\"https://github.com/Rolisteam/DiceParser/blob/master/HelpMe.md\">Documentation</a>");
+    m_diceParser->setOutputCacheSize(256);
     // using namespace ;
     m_server= new qhttp::server::QHttpServer(this);
     m_server->listen( // listening on 0.0.0.0:8080
@@ -180,7 +181,10 @@ QString DiceServer::diceToText(ExportedDiceResult& dice, bool highlight, bool ho
 
 QString DiceServer::startDiceParsing(QString cmd)
 {
-    QString result("");
+    // commands without dice are answered from the cache, they are neither parsed nor run.
+    QString result= m_diceParser->cachedOutput(cmd, QStringLiteral("html"));
+    if(!result.isNull())
+        return result;
     bool highlight= true;
     if(m_diceParser->parseLine(cmd))
     {
@@ -233,5 +237,6 @@ QString DiceServer::startDiceParsing(QString cmd)
         result+= "<span style=\"color: #00FF00\">Error:</span>" + m_diceParser->humanReadableError() + "<br/>";
     }
 
+    m_diceParser->storeOutput(QStringLiteral("html"), result);
     return result;
 }